@@ -37,8 +37,10 @@ int8_t Cmd_verb(int8_t argc, char * argv[]);
 //   1) add the command string to the 'MenuCmd#' item
 //   2) add the command help string to the 'MenuHelp#' item
 //   3) add the function prototype for the command's function above
-//   4) add the 'MenuCmd#', function's name, and 'MenuHelp#' to the 'g_sCmdTable[]' array
-//   5) add the function for processing the command to this file
+//   4) optionally add the command's argument schema to the 'Args#' item
+//   5) add the 'MenuCmd#', function's name, 'MenuHelp#', and '&Args#' (or NULL) to the
+//      'g_sCmdTable[]' array
+//   6) add the function for processing the command to this file
 //
 //*****************************************************************************
 
@@ -61,6 +63,16 @@ const char MenuHelpInput[] PROGMEM =     " [vals]          : Show/set command li
 const char MenuHelpErrs[] PROGMEM =     " errnum           : Check custom error responses";
 const char MenuHelpVerb[] PROGMEM =     " [<on | off>]     : Show/set verbose error responses flag";
 
+// menu items individual command argument schemas (arguments checked/converted before the command function is called)
+const uint8_t TypesKeyword[] PROGMEM = { CMDLINE_ARG_KEYWORD };
+const uint8_t TypesInt[] PROGMEM     = { CMDLINE_ARG_INT };
+const char KeywordsLed[] PROGMEM = "on|off|hb";
+const tCmdLineArgs ArgsLed PROGMEM   = { 0, 1, TypesKeyword, KeywordsLed };
+const tCmdLineArgs ArgsInput PROGMEM = { 0, 1, TypesInt, NULL };
+const tCmdLineArgs ArgsErrs PROGMEM  = { 1, 1, TypesInt, NULL };
+const char KeywordsVerb[] PROGMEM = "on|off";
+const tCmdLineArgs ArgsVerb PROGMEM  = { 0, 1, TypesKeyword, KeywordsVerb };
+
 //*****************************************************************************
 //
 // This is the table that holds the command names, implementing functions,
@@ -69,16 +81,16 @@ const char MenuHelpVerb[] PROGMEM =     " [<on | off>]     : Show/set verbose er
 //*****************************************************************************
 const tCmdLineEntry g_sCmdTable[] PROGMEM =
 {
-    //  command      function        help info
-    { MenuCmdHelp1,  Cmd_help,   MenuHelp1     },
-    { MenuCmdHelp2,  Cmd_help,   MenuHelp2     },
-    { MenuCmdHelp3,  Cmd_help,   MenuHelp2     },
-    { MenuCmdLed,    Cmd_led,    MenuHelpLed   },
-    { MenuCmdShow,   Cmd_show,   MenuHelpShow  },
-    { MenuCmdInput,  Cmd_input,  MenuHelpInput },
-    { MenuCmdErrs,   Cmd_errs,   MenuHelpErrs  },
-    { MenuCmdVerb,   Cmd_verb,   MenuHelpVerb  },
-    { 0, 0, 0 }     // end of commands
+    //  command      function    help info       argument schema
+    { MenuCmdHelp1,  Cmd_help,   MenuHelp1,      NULL       },
+    { MenuCmdHelp2,  Cmd_help,   MenuHelp2,      NULL       },
+    { MenuCmdHelp3,  Cmd_help,   MenuHelp2,      NULL       },
+    { MenuCmdLed,    Cmd_led,    MenuHelpLed,    &ArgsLed   },
+    { MenuCmdShow,   Cmd_show,   MenuHelpShow,   NULL       },
+    { MenuCmdInput,  Cmd_input,  MenuHelpInput,  &ArgsInput },
+    { MenuCmdErrs,   Cmd_errs,   MenuHelpErrs,   &ArgsErrs  },
+    { MenuCmdVerb,   Cmd_verb,   MenuHelpVerb,   &ArgsVerb  },
+    { 0, 0, 0, 0 }  // end of commands
 };
 
 /*
@@ -93,6 +105,8 @@ const tCmdLineEntry g_sCmdTable[] PROGMEM =
  *  Implements the "led" command to query status of and turn the on-board LED on or
  *  off or heartbeat.
  *
+ *  The argument is checked by the command's argument schema ('ArgsLed').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -101,31 +115,23 @@ const tCmdLineEntry g_sCmdTable[] PROGMEM =
  */
 int8_t Cmd_led(int8_t argc, char * argv[])
 {
-	if (argc > 2)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc > 1)      // has a command argument
-	{
-		if (strcmp_P(argv[ARG1], PSTR("on")) == 0)
-		{
-            LED_on();
-            LedState = LED_ON;
-		}
-		else if (strcmp_P(argv[ARG1], PSTR("off")) == 0)
-		{
-            LED_off();
-            LedState = LED_OFF;
-		}
-		else if (strcmp_P(argv[ARG1], PSTR("hb")) == 0)
-		{
-            LedState = LED_HB;
-		}
-		else    // unknown/invalid argument
-		{
-			return CMDLINE_BAD_CMD;
-		}
-	}
+    if (argc > 1)      // has a command argument (a keyword index, per the argument schema)
+    {
+        switch (CmdLine.ArgValue(ARG1))
+        {
+            case 0:     // "on"
+                LED_on();
+                LedState = LED_ON;
+                break;
+            case 1:     // "off"
+                LED_off();
+                LedState = LED_OFF;
+                break;
+            case 2:     // "hb"
+                LedState = LED_HB;
+                break;
+        }
+    }
 
     Serial.print(F("On-Board LED: "));
     switch (LedState)
@@ -223,6 +229,8 @@ int8_t Cmd_show(int8_t argc, char * argv[])
  * WHAT:
  *  Implements the "input" command to show/set the example numeric input values.
  *
+ *  The argument is checked and converted by the command's argument schema ('ArgsInput').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -232,28 +240,22 @@ int8_t Cmd_show(int8_t argc, char * argv[])
 int8_t Cmd_input(int8_t argc, char * argv[])
 {
     int32_t val;
-    int8_t paramtype;
 
-	if (argc > CMDLINE_MAX_ARGS)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc > 1)
-	{
-        // get the input value
-        paramtype = CmdLine.ParseParam(argv[ARG1], &val);
-        if ((paramtype == BADPARAM) || (paramtype == STRVAL) ||
-            (val < -1000000) || (val > 1000000))
+    if (argc > 1)
+    {
+        // get the input value (converted per the argument schema)
+        val = CmdLine.ArgValue(ARG1);
+        if ((val < -1000000) || (val > 1000000))
         {
             return CMDLINE_INVALID_ARG;
         }
-        if (paramtype == DECVAL)
+        if (CmdLine.ArgIsHex(ARG1))
         {
-            Serial.print(F("Dec:"));
+            Serial.print(F("Hex:"));
         }
-        else if (paramtype == HEXVAL)
+        else
         {
-            Serial.print(F("Hex:"));
+            Serial.print(F("Dec:"));
         }
         Input_Value = val;
     }
@@ -276,6 +278,8 @@ int8_t Cmd_input(int8_t argc, char * argv[])
  * WHAT:
  *  Implements the "errs" command to check custom error responses.
  *
+ *  The argument is checked and converted by the command's argument schema ('ArgsErrs').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -285,40 +289,24 @@ int8_t Cmd_input(int8_t argc, char * argv[])
 int8_t Cmd_errs(int8_t argc, char * argv[])
 {
     int32_t val;
-    int8_t paramtype;
 
-	if (argc > CMDLINE_MAX_ARGS)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc == 2)
-	{
-        // get the input value
-        paramtype = CmdLine.ParseParam(argv[ARG1], &val);
-        if ((paramtype == BADPARAM) || (paramtype == STRVAL) ||
-            (val < -127) || (val > 127))
-        {
-            return CMDLINE_INVALID_ARG;
-        }
-
-        switch (val)
-        {
-            case CMDLINE_BAD_CMD:           // -1
-            case CMDLINE_TOO_MANY_ARGS:     // -2
-            case CMDLINE_TOO_FEW_ARGS:      // -3
-            case CMDLINE_INVALID_ARG:       // -4
-            default:                        // all else
-                return (int8_t)val;
-                break;
-        }
+    // get the input value (converted per the argument schema)
+    val = CmdLine.ArgValue(ARG1);
+    if ((val < -127) || (val > 127))
+    {
+        return CMDLINE_INVALID_ARG;
     }
-	else
-	{
-		return CMDLINE_TOO_FEW_ARGS;
-	}
 
-    // Return success.
-    return 0;
+    switch (val)
+    {
+        case CMDLINE_BAD_CMD:           // -1
+        case CMDLINE_TOO_MANY_ARGS:     // -2
+        case CMDLINE_TOO_FEW_ARGS:      // -3
+        case CMDLINE_INVALID_ARG:       // -4
+        default:                        // all else
+            return (int8_t)val;
+            break;
+    }
 }
 
 /*
@@ -332,6 +320,8 @@ int8_t Cmd_errs(int8_t argc, char * argv[])
  * WHAT:
  *  Implements the "verb" command to query status of and set verbose error responses enable.
  *
+ *  The argument is checked by the command's argument schema ('ArgsVerb').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -340,25 +330,10 @@ int8_t Cmd_errs(int8_t argc, char * argv[])
  */
 int8_t Cmd_verb(int8_t argc, char * argv[])
 {
-	if (argc > 2)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc > 1)      // has a command argument
-	{
-		if (strcmp_P(argv[ARG1], PSTR("on")) == 0)
-		{
-            VerboseErrsEnabled = true;
-		}
-		else if (strcmp_P(argv[ARG1], PSTR("off")) == 0)
-		{
-            VerboseErrsEnabled = false;
-		}
-		else    // unknown/invalid argument
-		{
-			return CMDLINE_BAD_CMD;
-		}
-	}
+    if (argc > 1)      // has a command argument (a keyword index, per the argument schema)
+    {
+        VerboseErrsEnabled = (CmdLine.ArgValue(ARG1) == 0);     // "on"
+    }
 
     Serial.print(F("Verbose Error Responses: "));
     if (VerboseErrsEnabled)
@@ -35,8 +35,10 @@ int8_t Cmd_input(int8_t argc, char * argv[]);
 //   1) add the command string to the 'MenuCmd#' item
 //   2) add the command help string to the 'MenuHelp#' item
 //   3) add the function prototype for the command's function above
-//   4) add the 'MenuCmd#', function's name, and 'MenuHelp#' to the 'g_sCmdTable[]' array
-//   5) add the function for processing the command to this file
+//   4) optionally add the command's argument schema to the 'Args#' item
+//   5) add the 'MenuCmd#', function's name, 'MenuHelp#', and '&Args#' (or NULL) to the
+//      'g_sCmdTable[]' array
+//   6) add the function for processing the command to this file
 //
 //*****************************************************************************
 
@@ -55,6 +57,13 @@ const char MenuHelpLed[] PROGMEM   =   " [<on | off | hb>] : Show/control the LE
 const char MenuHelpShow[] PROGMEM  =    " [params]         : Show command line parameters";
 const char MenuHelpInput[] PROGMEM =     " [vals]          : Show/set command line numeric value";
 
+// menu items individual command argument schemas (arguments checked/converted before the command function is called)
+const uint8_t TypesLed[] PROGMEM   = { CMDLINE_ARG_KEYWORD };
+const uint8_t TypesInput[] PROGMEM = { CMDLINE_ARG_INT };
+const char KeywordsLed[] PROGMEM = "on|off|hb";
+const tCmdLineArgs ArgsLed PROGMEM   = { 0, 1, TypesLed, KeywordsLed };
+const tCmdLineArgs ArgsInput PROGMEM = { 0, 1, TypesInput, NULL };
+
 //*****************************************************************************
 //
 // This is the table that holds the command names, implementing functions,
@@ -63,14 +72,14 @@ const char MenuHelpInput[] PROGMEM =     " [vals]          : Show/set command li
 //*****************************************************************************
 const tCmdLineEntry g_sCmdTable[] PROGMEM =
 {
-    //  command     function        help info
-    { MenuCmdHelp1, Cmd_help,  MenuHelp1     },
-    { MenuCmdHelp2, Cmd_help,  MenuHelp2     },
-    { MenuCmdHelp3, Cmd_help,  MenuHelp2     },
-    { MenuCmdLed,   Cmd_led,   MenuHelpLed   },
-    { MenuCmdShow,  Cmd_show,  MenuHelpShow  },
-    { MenuCmdInput, Cmd_input, MenuHelpInput },
-    { 0, 0, 0 }     // end of commands
+    //  command     function   help info       argument schema
+    { MenuCmdHelp1, Cmd_help,  MenuHelp1,      NULL       },
+    { MenuCmdHelp2, Cmd_help,  MenuHelp2,      NULL       },
+    { MenuCmdHelp3, Cmd_help,  MenuHelp2,      NULL       },
+    { MenuCmdLed,   Cmd_led,   MenuHelpLed,    &ArgsLed   },
+    { MenuCmdShow,  Cmd_show,  MenuHelpShow,   NULL       },
+    { MenuCmdInput, Cmd_input, MenuHelpInput,  &ArgsInput },
+    { 0, 0, 0, 0 }  // end of commands
 };
 
 /*
@@ -85,6 +94,8 @@ const tCmdLineEntry g_sCmdTable[] PROGMEM =
  *  Implements the "led" command to query status of and turn the on-board LED on or
  *  off or heartbeat.
  *
+ *  The argument is checked by the command's argument schema ('ArgsLed').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -93,31 +104,23 @@ const tCmdLineEntry g_sCmdTable[] PROGMEM =
  */
 int8_t Cmd_led(int8_t argc, char * argv[])
 {
-	if (argc > 2)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc > 1)      // has a command argument
-	{
-		if (strcmp_P(argv[ARG1], PSTR("on")) == 0)
-		{
-            LED_on();
-            LedState = LED_ON;
-		}
-		else if (strcmp_P(argv[ARG1], PSTR("off")) == 0)
-		{
-            LED_off();
-            LedState = LED_OFF;
-		}
-		else if (strcmp_P(argv[ARG1], PSTR("hb")) == 0)
-		{
-            LedState = LED_HB;
-		}
-		else    // unknown/invalid argument
-		{
-			return CMDLINE_BAD_CMD;
-		}
-	}
+    if (argc > 1)      // has a command argument (a keyword index, per the argument schema)
+    {
+        switch (CmdLine.ArgValue(ARG1))
+        {
+            case 0:     // "on"
+                LED_on();
+                LedState = LED_ON;
+                break;
+            case 1:     // "off"
+                LED_off();
+                LedState = LED_OFF;
+                break;
+            case 2:     // "hb"
+                LedState = LED_HB;
+                break;
+        }
+    }
 
     Serial.print(F("On-Board LED: "));
     switch (LedState)
@@ -218,6 +221,8 @@ int8_t Cmd_show(int8_t argc, char * argv[])
  * WHAT:
  *  Implements the "input" command to show/set the example numeric input values.
  *
+ *  The argument is checked and converted by the command's argument schema ('ArgsInput').
+ *
  * RETURN VALUES:
  *  int8_t = 0 = command successfully processed
  *
@@ -226,29 +231,23 @@ int8_t Cmd_show(int8_t argc, char * argv[])
  */
 int8_t Cmd_input(int8_t argc, char * argv[])
 {
-    uint32_t val;
-    int8_t paramtype;
+    int32_t val;
 
-	if (argc > CMDLINE_MAX_ARGS)
-	{
-		return CMDLINE_TOO_MANY_ARGS;
-	}
-	else if (argc > 1)
-	{
-        // get the input value
-        paramtype = CmdLine.ParseParam(argv[ARG1], &val);
-        if ((paramtype == BADPARAM) || (paramtype == STRVAL) ||
-            (val < 1) || (val > 1000000))
+    if (argc > 1)
+    {
+        // get the input value (converted per the argument schema)
+        val = CmdLine.ArgValue(ARG1);
+        if ((val < 1) || (val > 1000000))
         {
             return CMDLINE_INVALID_ARG;
         }
-        if (paramtype == DECVAL)
+        if (CmdLine.ArgIsHex(ARG1))
         {
-            Serial.print(F("Dec:"));
+            Serial.print(F("Hex:"));
         }
-        else if (paramtype == HEXVAL)
+        else
         {
-            Serial.print(F("Hex:"));
+            Serial.print(F("Dec:"));
         }
         Input_Value = val;
     }
@@ -279,7 +278,8 @@ int8_t Cmd_input(int8_t argc, char * argv[])
  *  int8_t = 0 = command successfully processed
  *
  * SPECIAL CONSIDERATIONS:
- *  None.
+ *  The list of commands is shown by the following DoCmdLine() calls (so the
+ *  loop is not stalled by a long list on a slow serial port).
  */
 int8_t Cmd_help(int8_t argc, char * argv[])
 {
@@ -298,7 +298,7 @@ int8_t Cmd_help(int8_t argc, char * argv[])
     Serial.println(F("Available commands"));
     Serial.println(F("------------------"));
 
-    CmdLine.ShowCommands();     // show commands menu with help information
+    CmdLine.ShowCommandsAsync();    // show commands menu with help information (one command per DoCmdLine() call)
 
     // Return success.
     return 0;
@@ -0,0 +1,210 @@
+/*
+ * NAME: Arduino.cpp
+ *
+ * WHAT:
+ *  Minimal host (Linux) implementation of the Arduino core pieces declared
+ *  in the host 'Arduino.h', 'Print.h' and 'Stream.h' stand-ins.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <chrono>
+#include <thread>
+
+#include "Arduino.h"
+
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+unsigned long micros(void)
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+}
+
+unsigned long millis(void)
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+//
+// Print
+//
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+    size_t n = 0;
+
+    while (size--)
+    {
+        if (write(*buffer++))
+        {
+            ++n;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return n;
+}
+
+size_t Print::write(const char * str)
+{
+    if (str == NULL)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const __FlashStringHelper * str)
+{
+    return write((const char *)str);
+}
+
+size_t Print::print(const char * str)
+{
+    return write(str);
+}
+
+size_t Print::print(char ch)
+{
+    return write((uint8_t)ch);
+}
+
+size_t Print::print(int val, int base)
+{
+    return print((long)val, base);
+}
+
+size_t Print::print(unsigned int val, int base)
+{
+    return print((unsigned long)val, base);
+}
+
+size_t Print::print(long val, int base)
+{
+    if ((base == 10) && (val < 0))
+    {
+        size_t n = print('-');
+        return n + printNumber(0UL - (unsigned long)val, 10);
+    }
+    return printNumber((unsigned long)val, base);
+}
+
+size_t Print::print(unsigned long val, int base)
+{
+    return printNumber(val, base);
+}
+
+size_t Print::println(void)
+{
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper * str)
+{
+    size_t n = print(str);
+    return n + println();
+}
+
+size_t Print::println(const char * str)
+{
+    size_t n = print(str);
+    return n + println();
+}
+
+size_t Print::println(char ch)
+{
+    size_t n = print(ch);
+    return n + println();
+}
+
+size_t Print::println(int val, int base)
+{
+    size_t n = print(val, base);
+    return n + println();
+}
+
+size_t Print::println(unsigned int val, int base)
+{
+    size_t n = print(val, base);
+    return n + println();
+}
+
+size_t Print::println(long val, int base)
+{
+    size_t n = print(val, base);
+    return n + println();
+}
+
+size_t Print::println(unsigned long val, int base)
+{
+    size_t n = print(val, base);
+    return n + println();
+}
+
+size_t Print::printNumber(unsigned long val, int base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char * str = &buf[sizeof(buf) - 1];
+
+    if (base < 2)
+    {
+        base = 10;
+    }
+    *str = '\0';
+    do
+    {
+        char digit = (char)(val % base);
+        val /= base;
+        *--str = (digit < 10) ? (digit + '0') : (digit + 'A' - 10);
+    } while (val);
+
+    return write(str);
+}
+
+//
+// Stream
+//
+int Stream::timedRead(void)
+{
+    unsigned long start = millis();
+
+    do
+    {
+        int ch = read();
+        if (ch >= 0)
+        {
+            return ch;
+        }
+    } while ((millis() - start) < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char * buffer, size_t length)
+{
+    size_t count = 0;
+
+    while (count < length)
+    {
+        int ch = timedRead();
+        if (ch < 0)
+        {
+            break;
+        }
+        *buffer++ = (char)ch;
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,68 @@
+/*
+ * NAME: Arduino.h
+ *
+ * WHAT:
+ *  Minimal host (Linux) stand-in for the Arduino core header.
+ *
+ *  Provides just enough of the Arduino API (types, PROGMEM access macros,
+ *  Print, Stream, micros()/millis()) to build the CommandLine library on a
+ *  workstation for benchmarking and testing.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Not part of the Arduino library build (the 'extras' folder is ignored by
+ *  the Arduino IDE). Flash and RAM are the same address space on the host, so
+ *  all of the PROGMEM helpers are plain memory accesses.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Flash (program memory) access - Flash is ordinary memory on the host
+#define PROGMEM
+#define PGM_P               const char *
+#define PSTR(s)             (s)
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(addr))
+#define pgm_read_dword(addr)    (*(addr))
+#define pgm_read_ptr(addr)      (*(addr))
+#define strcmp_P            strcmp
+#define strcasecmp_P        strcasecmp
+#define strlen_P            strlen
+#define memcpy_P            memcpy
+
+class __FlashStringHelper;
+#define F(s)                (reinterpret_cast<const __FlashStringHelper *>(s))
+
+#define HIGH        1
+#define LOW         0
+#define OUTPUT      1
+#define INPUT       0
+#define LED_BUILTIN 13
+
+#define DEC         10
+#define HEX         16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+#include "Print.h"
+#include "Stream.h"
+
+#endif // __HOST_ARDUINO_H__
@@ -0,0 +1,132 @@
+/*
+ * NAME: MockStream.h
+ *
+ * WHAT:
+ *  In-memory 'Stream' for driving the CommandLine library on the host.
+ *
+ *  Input is read from a caller supplied buffer (which can be rewound to replay
+ *  the same input), output is counted and optionally captured. The room for
+ *  output (availableForWrite()) can be limited, the writes then use it up.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The input buffer is not copied - it must stay valid while in use.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+#ifndef __HOST_MOCKSTREAM_H__
+#define __HOST_MOCKSTREAM_H__
+
+#include <string>
+
+#include "Arduino.h"
+
+class MockStream : public Stream
+{
+    public:
+        MockStream() : in(NULL), inLen(0), inPos(0), outCount(0), writeCalls(0), writeRoom(-1), capture(false) {}
+
+        // sets the input buffer (and rewinds to its start)
+        void SetInput(const char * data, size_t len)
+        {
+            in = data;
+            inLen = len;
+            inPos = 0;
+        }
+        void SetInput(const char * data)
+        {
+            SetInput(data, strlen(data));
+        }
+
+        // replays the current input buffer from its start
+        void Rewind(void)
+        {
+            inPos = 0;
+        }
+
+        // enables/disables keeping a copy of the output
+        void Capture(bool enable)
+        {
+            capture = enable;
+        }
+
+        void ClearOutput(void)
+        {
+            output.clear();
+            outCount = 0;
+            writeCalls = 0;
+        }
+
+        // limits the room for output to 'room' bytes (-1 = no limit)
+        void SetWriteRoom(int room)
+        {
+            writeRoom = room;
+        }
+
+        const std::string& Output(void) const { return output; }
+        size_t OutCount(void) const { return outCount; }
+        size_t WriteCalls(void) const { return writeCalls; }
+
+        // Stream
+        virtual int available(void)
+        {
+            return (int)(inLen - inPos);
+        }
+        virtual int read(void)
+        {
+            return (inPos < inLen) ? (uint8_t)in[inPos++] : -1;
+        }
+        virtual int peek(void)
+        {
+            return (inPos < inLen) ? (uint8_t)in[inPos] : -1;
+        }
+
+        // Print
+        virtual size_t write(uint8_t ch)
+        {
+            ++writeCalls;
+            ++outCount;
+            UseRoom(1);
+            if (capture)
+            {
+                output += (char)ch;
+            }
+            return 1;
+        }
+        virtual size_t write(const uint8_t * buffer, size_t size)
+        {
+            ++writeCalls;
+            outCount += size;
+            UseRoom(size);
+            if (capture)
+            {
+                output.append((const char *)buffer, size);
+            }
+            return size;
+        }
+        virtual int availableForWrite(void)
+        {
+            return (writeRoom < 0) ? 64 : writeRoom;
+        }
+
+    private:
+        void UseRoom(size_t size)
+        {
+            if (writeRoom >= 0)
+            {
+                writeRoom = ((size_t)writeRoom > size) ? (int)(writeRoom - size) : 0;
+            }
+        }
+
+        const char * in;
+        size_t inLen;
+        size_t inPos;
+        size_t outCount;
+        size_t writeCalls;
+        int writeRoom;
+        bool capture;
+        std::string output;
+};
+
+#endif // __HOST_MOCKSTREAM_H__
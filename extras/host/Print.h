@@ -0,0 +1,62 @@
+/*
+ * NAME: Print.h
+ *
+ * WHAT:
+ *  Minimal host (Linux) stand-in for the Arduino core 'Print' class.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Only the members used by the CommandLine library, its examples and the
+ *  host benchmarks are provided. Mirrors the Arduino core layout: the single
+ *  character write() is pure virtual, the buffer write() and
+ *  availableForWrite() may be overridden.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+#ifndef __HOST_PRINT_H__
+#define __HOST_PRINT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+class __FlashStringHelper;
+
+class Print
+{
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t ch) = 0;
+        virtual size_t write(const uint8_t * buffer, size_t size);
+        size_t write(const char * str);
+        size_t write(const char * buffer, size_t size)
+        {
+            return write((const uint8_t *)buffer, size);
+        }
+
+        virtual int availableForWrite(void) { return 0; }
+        virtual void flush(void) {}
+
+        size_t print(const __FlashStringHelper * str);
+        size_t print(const char * str);
+        size_t print(char ch);
+        size_t print(int val, int base = 10);
+        size_t print(unsigned int val, int base = 10);
+        size_t print(long val, int base = 10);
+        size_t print(unsigned long val, int base = 10);
+
+        size_t println(void);
+        size_t println(const __FlashStringHelper * str);
+        size_t println(const char * str);
+        size_t println(char ch);
+        size_t println(int val, int base = 10);
+        size_t println(unsigned int val, int base = 10);
+        size_t println(long val, int base = 10);
+        size_t println(unsigned long val, int base = 10);
+
+    private:
+        size_t printNumber(unsigned long val, int base);
+};
+
+#endif // __HOST_PRINT_H__
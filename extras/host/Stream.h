@@ -0,0 +1,43 @@
+/*
+ * NAME: Stream.h
+ *
+ * WHAT:
+ *  Minimal host (Linux) stand-in for the Arduino core 'Stream' class.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  As in the AVR/ArduinoCore-API cores, readBytes() is not virtual and is
+ *  built on the virtual read() (so it is the "slow" core implementation).
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+#ifndef __HOST_STREAM_H__
+#define __HOST_STREAM_H__
+
+#include "Print.h"
+
+class Stream : public Print
+{
+    public:
+        Stream() : _timeout(1000) {}
+
+        virtual int available(void) = 0;
+        virtual int read(void) = 0;
+        virtual int peek(void) = 0;
+
+        void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+        size_t readBytes(char * buffer, size_t length);
+        size_t readBytes(uint8_t * buffer, size_t length)
+        {
+            return readBytes((char *)buffer, length);
+        }
+
+    protected:
+        unsigned long _timeout;
+
+        int timedRead(void);
+};
+
+#endif // __HOST_STREAM_H__
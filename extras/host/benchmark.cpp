@@ -0,0 +1,328 @@
+/*
+ * NAME: benchmark.cpp
+ *
+ * WHAT:
+ *  Host (Linux) benchmark suite for the CommandLine library.
+ *
+ *  Measures:
+ *   - command lines per second through DoCmdLine() (echo on and off, and queued),
+ *     and handed over with Feed()
+ *   - binary frames per second, and the bytes on the wire per command (text vs binary)
+ *   - ns per dispatch (first/last/unknown command) for the command table size,
+ *     with a linear search and with a hash index
+ *   - ParseParam() throughput
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command table size is fixed at compile time by BENCH_NUM_CMDS (10, 100
+ *  or 1000), so the Makefile builds one benchmark executable per table size.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <chrono>
+#include <string>
+
+#include "Arduino.h"
+#include "CommandLine.h"
+#include "MockStream.h"
+
+#ifndef BENCH_NUM_CMDS
+#define BENCH_NUM_CMDS      10
+#endif
+
+#define BENCH_NAME_SIZE     12
+#define BENCH_RUNS          5
+
+static char g_names[BENCH_NUM_CMDS][BENCH_NAME_SIZE];
+static const char BenchHelp[] PROGMEM = " : benchmark command";
+static volatile uint32_t g_calls;
+
+static int8_t Cmd_bench(int8_t argc, char * argv[])
+{
+    (void)argv;
+    g_calls += argc;
+    return 0;
+}
+
+static void NoErrs(int8_t err_code)
+{
+    (void)err_code;
+}
+
+//
+// The command table ("cmd0" ... "cmd<BENCH_NUM_CMDS - 1>").
+//
+#define E(i)        { g_names[(i)], Cmd_bench, BenchHelp, NULL },
+#define R10(b)      E((b) + 0) E((b) + 1) E((b) + 2) E((b) + 3) E((b) + 4) \
+                    E((b) + 5) E((b) + 6) E((b) + 7) E((b) + 8) E((b) + 9)
+#define R100(b)     R10((b) + 0) R10((b) + 10) R10((b) + 20) R10((b) + 30) R10((b) + 40) \
+                    R10((b) + 50) R10((b) + 60) R10((b) + 70) R10((b) + 80) R10((b) + 90)
+#define R1000(b)    R100((b) + 0) R100((b) + 100) R100((b) + 200) R100((b) + 300) R100((b) + 400) \
+                    R100((b) + 500) R100((b) + 600) R100((b) + 700) R100((b) + 800) R100((b) + 900)
+
+const tCmdLineEntry g_sCmdTable[] PROGMEM =
+{
+#if BENCH_NUM_CMDS == 10
+    R10(0)
+#elif BENCH_NUM_CMDS == 100
+    R100(0)
+#elif BENCH_NUM_CMDS == 1000
+    R1000(0)
+#else
+#error "BENCH_NUM_CMDS must be 10, 100 or 1000"
+#endif
+    { 0, 0, 0, 0 }  // end of commands
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double ElapsedNs(bench_clock::time_point start)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+}
+
+// builds an input buffer holding 'count' copies of 'line'
+static std::string Repeat(const std::string& line, uint32_t count)
+{
+    std::string s;
+
+    s.reserve(line.size() * count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        s += line;
+    }
+    return s;
+}
+
+// runs all of the input through DoCmdLine() 'passes' times, returns ns per line
+// (the best of BENCH_RUNS runs, to filter out scheduling noise)
+static double RunLines(CommandLine& cmdLine, MockStream& stream, const std::string& input,
+                       uint32_t lines, uint32_t passes)
+{
+    bench_clock::time_point start;
+    double ns;
+    double best = 0;
+
+    stream.SetInput(input.data(), input.size());
+    for (uint8_t run = 0; run < BENCH_RUNS; ++run)
+    {
+        start = bench_clock::now();
+        for (uint32_t p = 0; p < passes; ++p)
+        {
+            stream.Rewind();
+            while (cmdLine.DoCmdLine() || stream.available())
+            {
+            }
+        }
+        ns = ElapsedNs(start);
+        if ((run == 0) || (ns < best))
+        {
+            best = ns;
+        }
+    }
+    return best / ((double)lines * passes);
+}
+
+// hands all of the input to Feed() 'passes' times, returns ns per line
+// (the best of BENCH_RUNS runs)
+static double FeedLines(CommandLine& cmdLine, const std::string& input, uint32_t lines, uint32_t passes)
+{
+    bench_clock::time_point start;
+    double ns;
+    double best = 0;
+
+    for (uint8_t run = 0; run < BENCH_RUNS; ++run)
+    {
+        start = bench_clock::now();
+        for (uint32_t p = 0; p < passes; ++p)
+        {
+            cmdLine.Feed((const uint8_t *)input.data(), input.size());
+        }
+        ns = ElapsedNs(start);
+        if ((run == 0) || (ns < best))
+        {
+            best = ns;
+        }
+    }
+    return best / ((double)lines * passes);
+}
+
+static void BenchLines(void)
+{
+    const uint32_t lines = 1000;
+    const uint32_t passes = 200;
+    std::string input = Repeat("cmd0 12 0x1f -7 word\r", lines);
+    double ns;
+
+    MockStream stream;
+    CommandLine cmdLine(stream);
+    cmdLine.SetCustomErrorHandler(NoErrs);
+
+    for (int echo = 1; echo >= 0; --echo)
+    {
+        cmdLine.Echo(echo != 0);
+        stream.ClearOutput();
+        ns = RunLines(cmdLine, stream, input, lines, passes);
+        printf("cmds=%-5d lines/sec  (echo %-3s)           : %12.0f  (%.1f ns/line, %.2f writes/line)\n",
+               BENCH_NUM_CMDS, echo ? "on" : "off", 1e9 / ns, ns,
+               (double)stream.WriteCalls() / ((double)lines * passes * BENCH_RUNS));
+    }
+
+    // the command lines handed over by the caller (no stream polling)
+    ns = FeedLines(cmdLine, input, lines, passes);
+    printf("cmds=%-5d lines/sec  (echo off, Feed())   : %12.0f  (%.1f ns/line)\n",
+           BENCH_NUM_CMDS, 1e9 / ns, ns);
+
+    // pipelined command lines through a line queue
+    static CmdLineQueueN<8> queue;
+    cmdLine.SetLineQueue(queue);
+    ns = RunLines(cmdLine, stream, input, lines, passes);
+    printf("cmds=%-5d lines/sec  (echo off, queued)   : %12.0f  (%.1f ns/line)\n",
+           BENCH_NUM_CMDS, 1e9 / ns, ns);
+}
+
+// builds a binary frame of the command id and args (see CMDLINE_FRAME_SYNC)
+static std::string Frame(uint8_t id, const char * const * args, uint8_t count)
+{
+    std::string payload(1, (char)id);
+    std::string frame(1, (char)CMDLINE_FRAME_SYNC);
+    uint8_t crc;
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        payload += (char)strlen(args[i]);
+        payload += args[i];
+    }
+    frame += (char)payload.size();
+    frame += payload;
+    crc = CmdLineCrc8(0, (uint8_t)payload.size());
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        crc = CmdLineCrc8(crc, (uint8_t)payload[i]);
+    }
+    frame += (char)crc;
+    return frame;
+}
+
+static void BenchFrames(void)
+{
+    const uint32_t lines = 1000;
+    const uint32_t passes = 200;
+    static const char * const args[] = { "12", "0x1f", "-7", "word" };
+    const std::string line = "cmd0 12 0x1f -7 word\r";
+    std::string frame = Frame(0, args, 4);
+    std::string input = Repeat(frame, lines);
+    double ns;
+
+    MockStream stream;
+    CommandLine cmdLine(stream);
+    cmdLine.SetCustomErrorHandler(NoErrs);
+
+    // the text console bytes on the wire (echo on, the default)
+    stream.SetInput(line.data(), line.size());
+    while (cmdLine.DoCmdLine() || stream.available())
+    {
+    }
+    printf("cmds=%-5d wire bytes/cmd (text, echo on)   : %5u in %5u out\n",
+           BENCH_NUM_CMDS, (unsigned)line.size(), (unsigned)stream.OutCount());
+
+    cmdLine.FrameMode(CMDLINE_FRAME_BINARY);
+    stream.ClearOutput();
+    ns = RunLines(cmdLine, stream, input, lines, passes);
+    printf("cmds=%-5d wire bytes/cmd (binary frame)   : %5u in %5u out\n",
+           BENCH_NUM_CMDS, (unsigned)frame.size(),
+           (unsigned)(stream.OutCount() / ((uint64_t)lines * passes * BENCH_RUNS)));
+    printf("cmds=%-5d frames/sec (binary)             : %12.0f  (%.1f ns/frame)\n",
+           BENCH_NUM_CMDS, 1e9 / ns, ns);
+}
+
+static void BenchDispatch(void)
+{
+    const uint32_t lines = 1000;
+    const uint32_t passes = (BENCH_NUM_CMDS >= 1000) ? 20 : 200;
+    static const char * const labels[] = { "first", "last", "unknown" };
+    std::string names[3];
+    double ns;
+
+    names[0] = g_names[0];
+    names[1] = g_names[BENCH_NUM_CMDS - 1];
+    names[2] = "nosuchcmd";
+
+    static CmdLineHashIndexN<BENCH_NUM_CMDS> index;
+
+    for (uint8_t hashed = 0; hashed < 2; ++hashed)
+    {
+        MockStream stream;
+        CommandLine cmdLine(stream, false);
+        cmdLine.SetCustomErrorHandler(NoErrs);
+        if (hashed)
+        {
+            cmdLine.SetHashIndex(index);
+        }
+
+        for (uint8_t i = 0; i < 3; ++i)
+        {
+            std::string input = Repeat(names[i] + "\r", lines);
+            ns = RunLines(cmdLine, stream, input, lines, passes);
+            printf("cmds=%-5d ns/dispatch (%-7s, %-6s)   : %12.1f\n",
+                   BENCH_NUM_CMDS, labels[i], hashed ? "hash" : "linear", ns);
+        }
+    }
+}
+
+static void BenchParseParam(void)
+{
+    static const char * const params[] =
+    {
+        "1", "42", "1000000", "-123456", "2147483647", "0x1f", "0xDEADBEEF", "0x7fffffff"
+    };
+    const uint8_t count = sizeof(params) / sizeof(params[0]);
+    const uint32_t passes = 200000;
+    char bufs[count][16];
+    size_t chars = 0;
+    int32_t val;
+    uint32_t sum = 0;     // (unsigned, so it wraps without undefined behavior)
+    bench_clock::time_point start;
+    double ns;
+
+    MockStream stream;
+    CommandLine cmdLine(stream);
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        strcpy(bufs[i], params[i]);
+        chars += strlen(params[i]);
+    }
+
+    start = bench_clock::now();
+    for (uint32_t p = 0; p < passes; ++p)
+    {
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            val = 0;
+            cmdLine.ParseParam(bufs[i], &val);
+            sum += (uint32_t)val;
+        }
+    }
+    ns = ElapsedNs(start);
+    printf("cmds=%-5d ParseParam ns/call              : %12.1f  (%.1f MB/s, chk %lu)\n",
+           BENCH_NUM_CMDS, ns / ((double)count * passes),
+           ((double)chars * passes) / (ns / 1e9) / 1e6, (unsigned long)sum);
+}
+
+int main(void)
+{
+    for (uint16_t i = 0; i < BENCH_NUM_CMDS; ++i)
+    {
+        snprintf(g_names[i], BENCH_NAME_SIZE, "cmd%u", (unsigned)i);
+    }
+
+    BenchLines();
+    BenchFrames();
+    BenchDispatch();
+    BenchParseParam();
+
+    return 0;
+}
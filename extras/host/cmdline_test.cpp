@@ -0,0 +1,1316 @@
+/*
+ * NAME: cmdline_test.cpp
+ *
+ * WHAT:
+ *  Host (Linux) tests of the CommandLine receive path and command dispatch.
+ *
+ *  Each test feeds a command line input through a MockStream and checks what
+ *  the commands were called with and what was reported:
+ *   - dispatch: the command name (any case) and its arguments, repeated
+ *     delimiters, unknown commands and too many arguments
+ *   - split: a command line split across reads, longer than a receive chunk,
+ *     and several command lines in one read
+ *   - echo: the echoed characters (backspaces, and CR/LF only when enabled),
+ *     written a chunk at a time
+ *   - hash: the same commands are found through a hash index (and a table
+ *     too big for the index falls back to the linear search), the command name
+ *     hashed as it is received (backspaces, leading delimiters, batches, queued
+ *     command lines), and the undone hash steps
+ *   - tables: instances with their own command tables (sized or null ended)
+ *   - mux: two command lines share the multiplexer budget (a flooding command
+ *     line can not starve the other one)
+ *   - queue: pipelined command lines all run in one call (and a full queue
+ *     leaves the rest in the stream), and a line queue of over 127 lines
+ *     keeps its lines in order as it wraps
+ *   - budget: with a time budget, a call stops after the command that used it
+ *     up (the next call reports its status and runs the next command)
+ *   - schema: the converted argument values (and hex flags) of a command with
+ *     an argument schema, and the schema errors
+ *   - binary: binary frames (the status frames, a frame of the most bytes with a
+ *     long command name, a CRC error, a frame that is too long)
+ *   - framing: SLIP and COBS frames (8-bit clean, but a 0x00 drops the frame)
+ *   - batch: several commands in one command line (empty commands skipped,
+ *     stop or go on after an error, one unit of work for the time budget)
+ *   - parse: the ParseParam() types and values (the limits of each type, hex,
+ *     and 1 - 9 digits with a bad digit at each place)
+ *   - sizes: command lines sized at compile time (a small one takes less RAM
+ *     than a V1.10 CommandLine, its argument and line limits, and the argument
+ *     values of a schema past 16 arguments)
+ *   - output: an output queue (the output the stream has no room for is queued
+ *     and written by the following calls as the room allows, in order, the
+ *     overflow is dropped or waits for the stream)
+ *   - listing: a resumable command listing (one command per call, or as many as
+ *     the output queue has room for, the command lines received during it are
+ *     executed after it)
+ *   - pending: a command in progress is called again until it is done (its state
+ *     slot and argument values on each call, the default handler, a Ctrl-C
+ *     aborts it, the rest of its batch and the next command lines run after it)
+ *   - break: the break character aborts a command in progress (also after more
+ *     than CMDLINE_RX_CHUNK characters of type-ahead), stops a listing, discards
+ *     the command line being typed and the queued output, and can be disabled
+ *   - feed: command lines handed over with Feed() (across receive chunks, echoed
+ *     to its output, a command in progress leaves the rest to be fed again, the
+ *     break character in the rest, the rest of a batch, the output moved to
+ *     another Print or behind an output queue)
+ *   - tee: separate input and output, the output (echo, command output) mirrored
+ *     to each output of a CmdLineTee, its write count and room for output, and
+ *     an output queue in front of it waits for the output with the least room
+ *   - args: the command line split into arguments (and the command name hashed)
+ *     as it is received gives the same commands as the whole-line split (with a
+ *     line queue), also with backspaces, repeated delimiters, too many arguments,
+ *     a full command line buffer and a delimiter changed mid-line
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A failed check prints the test name and the line of the check.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <string>
+
+#include "Arduino.h"
+#include "CommandLine.h"
+#include "CommandLineMux.h"
+#include "MockStream.h"
+
+static uint32_t g_fails;
+
+#define CHECK(test, cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            printf("%s: check failed at line %d: %s (log: %s)\n", (test), __LINE__, #cond, g_log.c_str()); \
+            ++g_fails; \
+        } \
+    } while (0)
+
+// the command calls and reported errors, as text ("name(argv[0],argv[1]...) E<code> ...")
+static std::string g_log;
+
+static void LogErr(int8_t err_code)
+{
+    if (err_code == 0)
+    {
+        return;
+    }
+    g_log += "E" + std::to_string(err_code) + " ";
+}
+
+static void LogCall(const char * what, int8_t argc, char * argv[])
+{
+    g_log += what;
+    g_log += "(";
+    for (int8_t i = 0; i < argc; ++i)
+    {
+        g_log += (i ? "," : "");
+        g_log += argv[i];
+    }
+    g_log += ") ";
+}
+
+// "show <args...>" - logs its arguments
+static int8_t Cmd_show(int8_t argc, char * argv[])
+{
+    LogCall("show", argc, argv);
+    return 0;
+}
+
+// "slow" - logs its call, takes 2 ms and returns 5
+static int8_t Cmd_slow(int8_t argc, char * argv[])
+{
+    uint32_t start = micros();
+
+    LogCall("slow", argc, argv);
+    while ((uint32_t)(micros() - start) < 2000)
+    {
+    }
+    return 5;
+}
+
+// the command line of the command being executed
+static CommandLineBase * g_cmdLine;
+
+// "set <int> [on|off]" - logs its argument values
+static int8_t Cmd_set(int8_t argc, char * argv[])
+{
+    LogCall("set", argc, argv);
+    g_log += std::to_string(g_cmdLine->ArgValue(ARG1)) + (g_cmdLine->ArgIsHex(ARG1) ? "h" : "d") + "," +
+             std::to_string(g_cmdLine->ArgValue(ARG2)) + (g_cmdLine->ArgIsHex(ARG2) ? "h" : "d") + " ";
+    return 0;
+}
+
+static const uint8_t TypesSet[] PROGMEM = { CMDLINE_ARG_INT, CMDLINE_ARG_KEYWORD };
+static const char KeywordsSet[] PROGMEM = "on|off";
+static const tCmdLineArgs ArgsSet PROGMEM = { 1, 2, TypesSet, KeywordsSet };
+
+// (all string arguments)
+static const tCmdLineArgs ArgsStrs PROGMEM = { 0, 2, NULL, NULL };
+
+const tCmdLineEntry g_sCmdTable[] PROGMEM =
+{
+    { "show", Cmd_show, " <args...>", NULL },
+    { "shout", Cmd_show, " <args...>", NULL },
+    { "slow", Cmd_slow, "", NULL },
+    { "set", Cmd_set, " <int> [on|off]", &ArgsSet },
+    { "strs", Cmd_set, " [<str> [<str>]]", &ArgsStrs },
+    { "show_with_a_long_name", Cmd_show, " <args...>", NULL },
+    { 0, 0, 0, 0 }  // end of commands
+};
+
+// "wide <int> x 19" - logs the value (and hex flag) of its first and last arguments
+static int8_t Cmd_wide(int8_t argc, char * argv[])
+{
+    (void)argv;
+    g_log += "wide(" + std::to_string(argc) + ") " +
+             std::to_string(g_cmdLine->ArgValue(ARG1)) + (g_cmdLine->ArgIsHex(ARG1) ? "h" : "d") + "," +
+             std::to_string(g_cmdLine->ArgValue(19)) + (g_cmdLine->ArgIsHex(19) ? "h" : "d") + " ";
+    return 0;
+}
+
+static const uint8_t TypesWide[19] PROGMEM =
+{
+    CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT,
+    CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT,
+    CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT,
+    CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT, CMDLINE_ARG_INT
+};
+static const tCmdLineArgs ArgsWide PROGMEM = { 1, 19, TypesWide, NULL };
+
+const tCmdLineEntry g_sWideTable[] PROGMEM =
+{
+    { "wide", Cmd_wide, " <int> x 19", &ArgsWide },
+};
+
+// "help" - logs its call and starts a command listing
+static int8_t Cmd_help(int8_t argc, char * argv[])
+{
+    LogCall("help", argc, argv);
+    g_cmdLine->ShowCommandsAsync();
+    return 0;
+}
+
+const tCmdLineEntry g_sHelpTable[] PROGMEM =
+{
+    { "help", Cmd_help, " - list", NULL },
+    { "show", Cmd_show, " <args...>", NULL },
+    { 0, 0, 0, 0 }  // end of commands
+};
+
+// "wait" - in progress for 3 calls, then logs its arguments
+static int8_t Cmd_wait(int8_t argc, char * argv[])
+{
+    if (g_cmdLine->CmdState()++ < 3)
+    {
+        return CMDLINE_PENDING;
+    }
+    LogCall("wait", argc, argv);
+    return 0;
+}
+
+// "busy" - logs its call, in progress until aborted (logs its clean-up call)
+static int8_t Cmd_busy(int8_t argc, char * argv[])
+{
+    if (g_cmdLine->CmdAborted())
+    {
+        LogCall("aborted", argc, argv);
+        return CMDLINE_ABORTED;
+    }
+    if (g_cmdLine->CmdState()++ == 0)
+    {
+        LogCall("busy", argc, argv);
+    }
+    return CMDLINE_PENDING;
+}
+
+// "count <calls>" - in progress for <calls> calls, logs its argument value on each call
+static int8_t Cmd_count(int8_t argc, char * argv[])
+{
+    (void)argc;
+    (void)argv;
+    g_log += std::to_string(g_cmdLine->ArgValue(ARG1)) + " ";
+    return (++g_cmdLine->CmdState() < (uint32_t)g_cmdLine->ArgValue(ARG1)) ? CMDLINE_PENDING : 0;
+}
+
+static const uint8_t TypesCount[] PROGMEM = { CMDLINE_ARG_INT };
+static const tCmdLineArgs ArgsCount PROGMEM = { 1, 1, TypesCount, NULL };
+
+const tCmdLineEntry g_sPendingTable[] PROGMEM =
+{
+    { "show", Cmd_show, " <args...>", NULL },
+    { "wait", Cmd_wait, " <args...>", NULL },
+    { "busy", Cmd_busy, "", NULL },
+    { "count", Cmd_count, " <calls>", &ArgsCount },
+    { "help", Cmd_help, " - list", NULL },
+    { 0, 0, 0, 0 }  // end of commands
+};
+
+// the CommandLine object of V1.10 (80 byte command line, 10 arguments, 2 terminators)
+struct CommandLineV110
+{
+    Stream * serial;
+    struct
+    {
+        bool echoEnable;
+        bool crLfechoEnable;
+        bool crLfcmdEnable;
+        uint8_t index;
+        char g_cCmdBuf[80];
+    } input;
+    char * argv[10];
+    char delimiter;
+    char terminators[3];
+    pfnCmdLine defaultFunc;
+    pfnCustomErrs errorFunc;
+};
+
+// the bytes of a string literal (with any 0x00 bytes in it)
+template <size_t N>
+static std::string Bytes(const char (&str)[N])
+{
+    return std::string(str, N - 1);
+}
+
+// runs all of the input through DoCmdLine()
+static void Run(CommandLineBase& cmdLine, MockStream& stream, const std::string& input)
+{
+    g_log.clear();
+    stream.SetInput(input.data(), input.size());
+    for (int i = 0; i < 1000; ++i)
+    {
+        cmdLine.DoCmdLine();
+    }
+}
+
+static void TestDispatch(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    Run(cmdLine, stream, "show a b\r");
+    CHECK("dispatch", g_log == "show(show,a,b) ");
+
+    // any case, repeated delimiters, and an LF after the CR
+    Run(cmdLine, stream, "  SHOW   a  b  \r\nShow\r");
+    CHECK("dispatch", g_log == "show(SHOW,a,b) show(Show) ");
+
+    // an unknown command, the most arguments, one too many, and an empty line
+    Run(cmdLine, stream, "nope x\rshow 1 2 3 4 5 6 7 8 9\rshow 1 2 3 4 5 6 7 8 9 10\r\r");
+    CHECK("dispatch", g_log == "E-1 show(show,1,2,3,4,5,6,7,8,9) E-2 ");
+
+    // another delimiter
+    cmdLine.Delimiter(',');
+    Run(cmdLine, stream, "show,a,,b\r");
+    CHECK("dispatch", g_log == "show(show,a,b) ");
+}
+
+static void TestSplit(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    // a command line split across reads
+    g_log.clear();
+    stream.SetInput("sho");
+    CHECK("split", cmdLine.DoCmdLine() == 0);
+    stream.SetInput("w a");
+    CHECK("split", cmdLine.DoCmdLine() == 0);
+    stream.SetInput(" b\r");
+    CHECK("split", cmdLine.DoCmdLine() == 1);
+    CHECK("split", g_log == "show(show,a,b) ");
+
+    // longer than a receive chunk
+    Run(cmdLine, stream, "show 0123456789 abcdefghijklmnopqrstuvwxyz 0123456789\r");
+    CHECK("split", g_log == "show(show,0123456789,abcdefghijklmnopqrstuvwxyz,0123456789) ");
+
+    // one command line per call, the rest of the read is kept for the next one
+    g_log.clear();
+    stream.SetInput("show a\rshow b\rsh");
+    CHECK("split", cmdLine.DoCmdLine() == 1);
+    CHECK("split", g_log == "show(show,a) ");
+    CHECK("split", cmdLine.DoCmdLine() == 1);
+    CHECK("split", cmdLine.DoCmdLine() == 0);
+    stream.SetInput("ow c\r");
+    CHECK("split", cmdLine.DoCmdLine() == 1);
+    CHECK("split", g_log == "show(show,a) show(show,b) show(show,c) ");
+}
+
+static void TestEcho(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, true);
+    cmdLine.SetCustomErrorHandler(LogErr);
+    stream.Capture(true);
+
+    // the backspace is echoed (and removes the character), the CR is not
+    Run(cmdLine, stream, "show ab\bc\r");
+    CHECK("echo", g_log == "show(show,ac) ");
+    CHECK("echo", stream.Output() == "show ab\bc\r\n");
+
+    // a backspace inside a chunk of echo (one write), and across receive chunks
+    stream.ClearOutput();
+    stream.SetInput("sx\bhow");
+    cmdLine.DoCmdLine();
+    CHECK("echo", stream.Output() == "sx\bhow");
+    CHECK("echo", stream.WriteCalls() == 1);
+    Run(cmdLine, stream, " 0123456\b789abcd\b\bef\r");
+    CHECK("echo", g_log == "show(show,012345789abef) ");
+    CHECK("echo", stream.Output() == "sx\bhow 0123456\b789abcd\b\bef\r\n");
+
+    // the high bit is stripped (in the echo too)
+    stream.ClearOutput();
+    Run(cmdLine, stream, "show \xe1\r");
+    CHECK("echo", g_log == "show(show,a) ");
+    CHECK("echo", stream.Output() == "show a\r\n");
+
+    stream.ClearOutput();
+    cmdLine.CrLfEcho(true);
+    cmdLine.CrLfCommand(false);
+    Run(cmdLine, stream, "show\r");
+    CHECK("echo", stream.Output() == "show\r");
+}
+
+static void TestHash(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineHashIndexN<8> index;
+    CmdLineHashIndexN<1> small;
+    CmdLineQueueN<4> queue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    CHECK("hash", cmdLine.SetHashIndex(index));
+    Run(cmdLine, stream, "show a\rSHOW b\rsho c\rshowx d\r");
+    CHECK("hash", g_log == "show(show,a) show(SHOW,b) E-1 E-1 ");
+
+    // the command name hashed as it is received
+    const char line[] = "  show x";
+    uint16_t hash = 0x1234;
+    index.NameStart();
+    index.NameAdd(0, ' ', true);
+    index.NameAdd(1, ' ', true);
+    index.NameAdd(2, 's', false);
+    index.NameAdd(3, 'H', false);
+    index.NameAdd(4, 'o', false);
+    index.NameAdd(5, 'X', false);
+    index.NameRemove(5, 'X');
+    index.NameAdd(5, 'w', false);
+    index.NameAdd(6, ' ', true);
+    index.NameRemove(6, ' ');   // (the name is open again)
+    index.NameAdd(6, ' ', true);
+    index.NameAdd(7, 'x', false);
+    CHECK("hash", index.NameHash(line, &line[2]) == CmdLineHashIndex::Hash("show"));
+    CHECK("hash", index.NameHash(line, &line[7]) == CmdLineHashIndex::Hash("x"));
+    for (uint16_t i = 0; i < 1000; ++i)
+    {
+        CHECK("hash", CmdLineHashUnstep(CmdLineHashStep(hash, 'A'), 'a') == hash);
+        hash = CmdLineHashStep(hash, (char)('a' + (i % 26)));
+    }
+
+    // received command lines (with backspaces, leading delimiters, batches, a line queue)
+    CHECK("hash", cmdLine.SetHashIndex(index));
+    Run(cmdLine, stream, "shoX\bw e\r  shout f\rshow \b\bw g\rx\b\bSHOW h\r");
+    CHECK("hash", g_log == "show(show,e) show(shout,f) show(show,g) show(SHOW,h) ");
+    cmdLine.BatchSeparator(';');
+    Run(cmdLine, stream, "shout;show i\rshowx\b j\r");
+    CHECK("hash", g_log == "show(shout) show(show,i) show(show,j) ");
+    CHECK("hash", cmdLine.SetLineQueue(queue));
+    Run(cmdLine, stream, "shout k;show l\rsho\r");
+    CHECK("hash", g_log == "show(shout,k) show(show,l) E-1 ");
+
+    // the table does not fit the index
+    CHECK("hash", !cmdLine.SetHashIndex(small));
+    Run(cmdLine, stream, "Show e\rshowx f\r");
+    CHECK("hash", g_log == "show(Show,e) E-1 ");
+}
+
+// "other <args...>" - logs its arguments
+static int8_t Cmd_other(int8_t argc, char * argv[])
+{
+    LogCall("other", argc, argv);
+    return 0;
+}
+
+// no null end entry (the size of the array ends it)
+const tCmdLineEntry g_sOtherTable[] PROGMEM =
+{
+    { "other", Cmd_other, " <args...>", NULL },
+    { "show", Cmd_other, " <args...>", NULL },
+};
+
+static void TestTables(void)
+{
+    MockStream stream1;
+    MockStream stream2;
+    CommandLine cmdLine1(stream1, false);                   // g_sCmdTable
+    CommandLine cmdLine2(stream2, g_sOtherTable);
+    cmdLine1.Echo(false);
+    cmdLine2.Echo(false);
+    cmdLine1.SetCustomErrorHandler(LogErr);
+    cmdLine2.SetCustomErrorHandler(LogErr);
+
+    // each instance dispatches from its own table
+    g_log.clear();
+    stream1.SetInput("show 1\rother 1\r");
+    stream2.SetInput("show 2\rother 2\r");
+    for (int i = 0; i < 4; ++i)
+    {
+        cmdLine1.DoCmdLine();
+        cmdLine2.DoCmdLine();
+    }
+    CHECK("tables", g_log == "show(show,1) other(show,2) E-1 other(other,2) ");
+
+    // only the first entry of the table
+    cmdLine2.SetCommandTable(g_sOtherTable, 1);
+    Run(cmdLine2, stream2, "other 3\rshow 3\r");
+    CHECK("tables", g_log == "other(other,3) E-1 ");
+
+    // back to a null ended table, with a hash index
+    CmdLineHashIndexN<8> index;
+    CHECK("tables", cmdLine2.SetHashIndex(index));
+    cmdLine2.SetCommandTable(g_sCmdTable);
+    Run(cmdLine2, stream2, "other 4\rshow 4\r");
+    CHECK("tables", g_log == "E-1 show(show,4) ");
+}
+
+static void TestMux(void)
+{
+    MockStream stream1;
+    MockStream stream2;
+    CommandLine cmdLine1(stream1, false);
+    CommandLine cmdLine2(stream2, g_sOtherTable);
+    CommandLineMux<2> mux(7);
+    std::string flood;
+    uint16_t done;
+    cmdLine2.Echo(false);
+    cmdLine1.SetCustomErrorHandler(LogErr);
+    cmdLine2.SetCustomErrorHandler(LogErr);
+
+    CHECK("mux", mux.Add(cmdLine1) == 0);
+    CHECK("mux", mux.Add(cmdLine2) == 1);
+    CHECK("mux", mux.Add(cmdLine2) == -1);
+
+    // a long command line on the first port does not hold up the second port
+    g_log.clear();
+    stream1.SetInput("show 0123456789abcdefghij\r");
+    stream2.SetInput("other\r");
+    done = mux.DoCmdLine();
+    CHECK("mux", done == 0x0002);
+    CHECK("mux", g_log == "other(other) ");
+    for (int i = 0; i < 3; ++i)
+    {
+        done = mux.DoCmdLine();
+    }
+    CHECK("mux", done == 0x0001);
+    CHECK("mux", g_log == "other(other) show(show,0123456789abcdefghij) ");
+
+    // both ports flooding: one command line from each per call, the first port rotating
+    g_log.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        flood += "show a\r";
+    }
+    stream1.SetInput(flood.data(), flood.size());
+    stream2.SetInput("other\rother\rother\r");
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK("mux", mux.DoCmdLine() == 0x0003);
+    }
+    CHECK("mux", g_log == "show(show,a) other(other) other(other) show(show,a) show(show,a) other(other) ");
+    CHECK("mux", mux.DoCmdLine() == 0x0001);
+    CHECK("mux", g_log == "show(show,a) other(other) other(other) show(show,a) show(show,a) other(other) show(show,a) ");
+}
+
+static void TestQueue(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineQueueN<2> lineQueue;
+    CmdLineQueueN<2, 8> shortQueue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    CHECK("queue", !cmdLine.SetLineQueue(shortQueue));
+    CHECK("queue", cmdLine.SetLineQueue(lineQueue));
+
+    // pipelined command lines run in one call, the third waits for the next call
+    g_log.clear();
+    stream.SetInput("show a\rshow b\rshow c\r");
+    CHECK("queue", cmdLine.DoCmdLine() == 1);
+    CHECK("queue", g_log == "show(show,a) show(show,b) ");
+    CHECK("queue", cmdLine.DoCmdLine() == 1);
+    CHECK("queue", g_log == "show(show,a) show(show,b) show(show,c) ");
+    CHECK("queue", cmdLine.DoCmdLine() == 0);
+
+    // fill it, then keep it full while taking lines off (the slots wrap)
+    static CmdLineQueueN<200, 8> queue;
+    char line[8];
+    char * pcLine;
+    bool crLf;
+    uint16_t pushed = 0;
+    uint16_t popped = 0;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        while (!queue.Full())
+        {
+            snprintf(line, sizeof(line), "%u", (unsigned)pushed++);
+            queue.Push(line, strlen(line), (pushed & 1) != 0);
+        }
+        for (int i = 0; i < 150; ++i)
+        {
+            pcLine = queue.Front(&crLf);
+            CHECK("queue", (pcLine != NULL) && (strtoul(pcLine, NULL, 10) == popped));
+            CHECK("queue", crLf == (((popped + 1) & 1) != 0));
+            ++popped;
+            queue.Pop();
+        }
+    }
+    CHECK("queue", queue.Count() == (pushed - popped));
+}
+
+static void TestBudget(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineQueueN<4> lineQueue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    // no time limit
+    g_log.clear();
+    stream.SetInput("slow\rshow a\r");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, CMDLINE_NO_TIME_LIMIT) == 1);
+    CHECK("budget", g_log == "slow(slow) E5 ");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, CMDLINE_NO_TIME_LIMIT) == 1);
+    CHECK("budget", g_log == "slow(slow) E5 show(show,a) ");
+
+    // a 1 ms budget, one command line at a time
+    g_log.clear();
+    stream.SetInput("slow\rshow b\r");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("budget", g_log == "slow(slow) ");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("budget", g_log == "slow(slow) E5 show(show,b) ");
+
+    // a 1 ms budget, with queued command lines
+    CHECK("budget", cmdLine.SetLineQueue(lineQueue));
+    g_log.clear();
+    stream.SetInput("slow\rslow\rshow c\r");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("budget", g_log == "slow(slow) ");
+    CHECK("budget", lineQueue.Count() == 2);
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("budget", g_log == "slow(slow) E5 slow(slow) ");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("budget", g_log == "slow(slow) E5 slow(slow) E5 show(show,c) ");
+    CHECK("budget", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 0);
+}
+
+static void TestSchema(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+    g_cmdLine = &cmdLine;
+
+    Run(cmdLine, stream, "set 12\rset 0x1F off\rset -7 ON\rstrs 5 0x5\r");
+    CHECK("schema", g_log == "set(set,12) 12d,0d set(set,0x1F,off) 31h,1d set(set,-7,ON) -7d,0d set(strs,5,0x5) 0d,0d ");
+
+    // a bad keyword, a bad number, too few and too many arguments
+    Run(cmdLine, stream, "set 1 hb\rset x1\rset\rset 1 on 2\rstrs a b c\r");
+    CHECK("schema", g_log == "E-4 E-4 E-3 E-2 E-2 ");
+
+    // not valid outside of a command
+    CHECK("schema", (cmdLine.ArgValue(ARG1) == 0) && !cmdLine.ArgIsHex(ARG1));
+}
+
+// builds a binary frame of the command id and its args (see CMDLINE_FRAME_SYNC)
+static std::string Frame(uint8_t id, const std::string& args)
+{
+    std::string payload(1, (char)id);
+    std::string frame(1, (char)CMDLINE_FRAME_SYNC);
+    uint8_t crc;
+
+    payload += args;
+    frame += (char)payload.size();
+    frame += payload;
+    crc = CmdLineCrc8(0, (uint8_t)payload.size());
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        crc = CmdLineCrc8(crc, (uint8_t)payload[i]);
+    }
+    frame += (char)crc;
+    return frame;
+}
+
+// a binary frame argument (its length byte and characters)
+static std::string Arg(const std::string& arg)
+{
+    return std::string(1, (char)arg.size()) + arg;
+}
+
+// a binary status frame
+static std::string Status(uint8_t id, int8_t status)
+{
+    std::string frame(1, (char)CMDLINE_FRAME_SYNC);
+
+    frame += (char)2;
+    frame += (char)id;
+    frame += (char)status;
+    frame += (char)CmdLineCrc8(CmdLineCrc8(CmdLineCrc8(0, 2), id), (uint8_t)status);
+    return frame;
+}
+
+static void TestBinary(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    const uint8_t longName = 5;                     // "show_with_a_long_name"
+    std::string longArg(CMDLINE_FRAME_MAX_LEN - 2, 'x');
+    std::string bad;
+
+    cmdLine.FrameMode(CMDLINE_FRAME_BINARY);
+    stream.Capture(true);
+
+    // a command, an unknown command id and the exit frame (back to the text console)
+    Run(cmdLine, stream, Frame(0, Arg("a") + Arg("bc")) + Frame(100, "") + Frame(CMDLINE_FRAME_EXIT, "") + "show d\r");
+    CHECK("binary", g_log == "show(show,a,bc) show(show,d) ");
+    CHECK("binary", stream.Output() == Status(0, 0) + Status(100, CMDLINE_BAD_CMD) + Status(CMDLINE_FRAME_EXIT, 0) + "\r\n");
+
+    // a frame of the most bytes, for a command with a long name
+    cmdLine.FrameMode(CMDLINE_FRAME_BINARY);
+    stream.ClearOutput();
+    Run(cmdLine, stream, Frame(longName, Arg(longArg)));
+    CHECK("binary", g_log == "show(show_with_a_long_name," + longArg + ") ");
+    CHECK("binary", stream.Output() == Status(longName, 0));
+
+    // a CRC error, then a frame that is one byte too long (dropped)
+    stream.ClearOutput();
+    bad = Frame(0, Arg("a"));
+    bad[bad.size() - 1] ^= 1;
+    Run(cmdLine, stream, bad + Frame(longName, Arg(longArg + "x")) + Frame(0, Arg("e")));
+    CHECK("binary", g_log == "show(show,e) ");
+    CHECK("binary", stream.Output() == Status(0, CMDLINE_BAD_FRAME) + Status(0, 0));
+}
+
+static void TestFraming(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    // SLIP: a good frame (with an escaped END), a frame with a 0x00, a good frame
+    cmdLine.FrameMode(CMDLINE_FRAME_SLIP);
+    Run(cmdLine, stream, Bytes("\xC0show a\xDB\xDC\xC0") + Bytes("show b\0c\xC0") + Bytes("show d\xC0"));
+    CHECK("framing", g_log == "show(show,a\xC0) show(show,d) ");
+
+    // COBS: the same (the 0x00 is the end of the block "show b")
+    cmdLine.FrameMode(CMDLINE_FRAME_COBS);
+    Run(cmdLine, stream, Bytes("\x08show a\xC0\0") + Bytes("\x07show b\x02" "c\0") + Bytes("\x07show d\0"));
+    CHECK("framing", g_log == "show(show,a\xC0) show(show,d) ");
+
+    // with a line queue, both frames run in one call
+    CmdLineQueueN<2> lineQueue;
+    CHECK("framing", cmdLine.SetLineQueue(lineQueue));
+    g_log.clear();
+    stream.SetInput("\x07show e\0\x07show f\0", 16);
+    CHECK("framing", cmdLine.DoCmdLine() == 1);
+    CHECK("framing", g_log == "show(show,e) show(show,f) ");
+}
+
+static void TestBatch(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    // no batches by default
+    Run(cmdLine, stream, "show a;show b\r");
+    CHECK("batch", g_log == "show(show,a;show,b) ");
+
+    // (a command line of only separators is a bad command, like a command line of only delimiters)
+    cmdLine.BatchSeparator(';');
+    Run(cmdLine, stream, "show a; show b;; ;show c\r;;\r  \r");
+    CHECK("batch", g_log == "show(show,a) show(show,b) show(show,c) E-1 E-1 ");
+
+    // the rest of the batch is skipped after an error (or not)
+    Run(cmdLine, stream, "show a;nope;show b\r");
+    CHECK("batch", g_log == "show(show,a) E-1 ");
+    cmdLine.BatchSeparator(';', false);
+    Run(cmdLine, stream, "show a;nope;show b\r");
+    CHECK("batch", g_log == "show(show,a) E-1 show(show,b) ");
+
+    // the whole batch runs in one call with a time budget
+    g_log.clear();
+    stream.SetInput("slow;show c\rshow d\r");
+    CHECK("batch", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("batch", g_log == "slow(slow) E5 show(show,c) ");
+    CHECK("batch", cmdLine.DoCmdLine(CMDLINE_NO_LIMIT, 1000) == 1);
+    CHECK("batch", g_log == "slow(slow) E5 show(show,c) show(show,d) ");
+}
+
+// parses a parameter into a value of type T, returns the parameter type and the value
+// (the value is 77 if it is not changed)
+template <typename T>
+static int8_t Parse(CommandLine& cmdLine, const std::string& text, T * val)
+{
+    char param[40];
+
+    snprintf(param, sizeof(param), "%s", text.c_str());
+    *val = 77;
+    return cmdLine.ParseParam(param, val);
+}
+
+#define CHECK_PARSE(type, text, ptype, value) \
+    do \
+    { \
+        type v; \
+        int8_t pt = Parse(cmdLine, (text), &v); \
+        if ((pt != (ptype)) || (v != (type)(value))) \
+        { \
+            printf("parse: check failed at line %d: \"%s\" = %d %lld\n", __LINE__, std::string(text).c_str(), pt, (long long)v); \
+            ++g_fails; \
+        } \
+    } while (0)
+
+static void TestParse(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream);
+    const std::string digits = "123456789";
+    const std::string hexDigits = "89aBcDeF";
+    std::string text;
+    int32_t dec = 0;
+    int32_t hex = 0;
+
+    CHECK_PARSE(int32_t, "123", DECVAL, 123);
+    CHECK_PARSE(int32_t, "-45", DECVAL, -45);
+    CHECK_PARSE(int32_t, "0x1F", HEXVAL, 0x1f);
+    CHECK_PARSE(int32_t, "\"str\"", STRVAL, 77);
+    CHECK_PARSE(int32_t, "12z", BADPARAM, 77);
+
+    // the limits (and one past them) of each type
+    CHECK_PARSE(int32_t, "2147483646", DECVAL, 2147483646);
+    CHECK_PARSE(int32_t, "2147483647", DECVAL, 2147483647);
+    CHECK_PARSE(int32_t, "2147483648", BADPARAM, 77);
+    CHECK_PARSE(int32_t, "-2147483647", DECVAL, -2147483647);
+    CHECK_PARSE(int32_t, "-2147483648", DECVAL, INT32_MIN);
+    CHECK_PARSE(int32_t, "-2147483649", BADPARAM, 77);
+    CHECK_PARSE(int32_t, "0xffffffff", HEXVAL, -1);
+    CHECK_PARSE(int32_t, "0x000000001", HEXVAL, 1);
+    CHECK_PARSE(int32_t, "0x100000000", BADPARAM, 77);
+    CHECK_PARSE(uint32_t, "4294967294", DECVAL, 4294967294U);
+    CHECK_PARSE(uint32_t, "4294967295", DECVAL, 4294967295U);
+    CHECK_PARSE(uint32_t, "4294967296", BADPARAM, 77);
+    CHECK_PARSE(uint32_t, "0", DECVAL, 0);
+    CHECK_PARSE(uint32_t, "-1", BADPARAM, 77);
+    CHECK_PARSE(uint32_t, "0xFFFFFFFF", HEXVAL, 4294967295U);
+    CHECK_PARSE(int64_t, "9223372036854775806", DECVAL, INT64_MAX - 1);
+    CHECK_PARSE(int64_t, "9223372036854775807", DECVAL, INT64_MAX);
+    CHECK_PARSE(int64_t, "9223372036854775808", BADPARAM, 77);
+    CHECK_PARSE(int64_t, "-9223372036854775807", DECVAL, INT64_MIN + 1);
+    CHECK_PARSE(int64_t, "-9223372036854775808", DECVAL, INT64_MIN);
+    CHECK_PARSE(int64_t, "-9223372036854775809", BADPARAM, 77);
+    CHECK_PARSE(int64_t, "0xffffffffffffffff", HEXVAL, -1);
+    CHECK_PARSE(int64_t, "0x10000000000000000", BADPARAM, 77);
+
+    // no digits, a negative zero and mixed-case hex
+    CHECK_PARSE(int32_t, "0x", BADPARAM, 77);
+    CHECK_PARSE(int32_t, "0X", BADPARAM, 77);
+    CHECK_PARSE(int32_t, "-", BADPARAM, 77);
+    CHECK_PARSE(int32_t, "-0", DECVAL, 0);
+    CHECK_PARSE(int32_t, "0XaBc", HEXVAL, 0xabc);
+    CHECK_PARSE(int32_t, "0xAbCdEf", HEXVAL, 0xabcdef);
+
+    // 1 - 9 digits (across the 4 digit blocks), and a bad digit at each place
+    for (size_t n = 1; n <= digits.size(); ++n)
+    {
+        dec = (dec * 10) + (int32_t)n;
+        CHECK_PARSE(int32_t, digits.substr(0, n), DECVAL, dec);
+        CHECK_PARSE(int32_t, "-" + digits.substr(0, n), DECVAL, -dec);
+        for (size_t i = 0; i < n; ++i)
+        {
+            text = digits.substr(0, n);
+            text[i] = (i & 1) ? ':' : '/';      // (just past '9' and just before '0')
+            CHECK_PARSE(int32_t, text, BADPARAM, 77);
+        }
+    }
+    for (size_t n = 1; n <= hexDigits.size(); ++n)
+    {
+        hex = (int32_t)(((uint32_t)hex << 4) | (uint32_t)(7 + n));
+        CHECK_PARSE(int32_t, "0x" + hexDigits.substr(0, n), HEXVAL, hex);
+        for (size_t i = 0; i < n; ++i)
+        {
+            text = "0x" + hexDigits.substr(0, n);
+            text[2 + i] = (i & 1) ? 'g' : 'G';
+            CHECK_PARSE(int32_t, text, BADPARAM, 77);
+        }
+    }
+}
+
+static void TestSizes(void)
+{
+    MockStream stream;
+    CommandLineN<16, 3, 1> tiny(stream, false);
+    CommandLineN<128, 20> wide(stream, g_sWideTable);
+    std::string line;
+    tiny.SetCustomErrorHandler(LogErr);
+    wide.SetCustomErrorHandler(LogErr);
+    wide.Echo(false);
+
+    // a small command line costs less RAM than any V1.10 command line did
+    CHECK("sizes", sizeof(tiny) < sizeof(CommandLineV110));
+    CHECK("sizes", sizeof(CommandLineN<16, 3, 1>) < sizeof(CommandLineN<80, 10, 2>));
+    CHECK("sizes", sizeof(CommandLineN<80, 10, 2>) == sizeof(CommandLine));
+
+    // command + 2 parameters, command lines of up to 15 characters (a full buffer ends the line)
+    Run(tiny, stream, "show a b\rshow a b c\rshow 0123456789abc\r");
+    CHECK("sizes", g_log == "show(show,a,b) E-2 show(show,0123456789) E-1 ");
+
+    // one terminator (the second one is not kept)
+    tiny.Terminators((char *)";\r");
+    Run(tiny, stream, "show a;show b\r;");
+    CHECK("sizes", g_log == "show(show,a;) show(show,b\r;) ");
+
+    // the argument values (and hex flags) of a schema past ARG9 (and 16 arguments)
+    g_cmdLine = &wide;
+    line = "wide 0x10";
+    for (int i = 2; i < 19; ++i)
+    {
+        line += " " + std::to_string(i);
+    }
+    Run(wide, stream, line + " 0x13\r" + line + " 19 20\r");
+    CHECK("sizes", g_log == "wide(20) 16h,19h E-2 ");
+}
+
+static void TestOutput(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, true);
+    CmdLineOutputN<8> queue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetOutput(queue);
+    stream.Capture(true);
+    CHECK("output", &cmdLine.Output() == &queue);
+
+    // room for 4 bytes: the rest of the echo is queued (the command still runs)
+    stream.SetWriteRoom(4);
+    Run(cmdLine, stream, "show ab\r");
+    CHECK("output", g_log == "show(show,ab) ");
+    CHECK("output", stream.Output() == "show");
+    CHECK("output", queue.Queued() == 5);
+
+    // each call writes what the stream has room for
+    stream.SetWriteRoom(3);
+    cmdLine.DoCmdLine();
+    CHECK("output", stream.Output() == "show ab");
+    CHECK("output", queue.Queued() == 2);
+    cmdLine.Output().print("x");
+    CHECK("output", queue.Queued() == 3);
+    stream.SetWriteRoom(-1);
+    cmdLine.DoCmdLine();
+    CHECK("output", stream.Output() == "show ab\r\nx");
+    CHECK("output", queue.Queued() == 0);
+
+    // the drop policy (the default): what does not fit in the queue is dropped
+    stream.ClearOutput();
+    stream.SetWriteRoom(0);
+    Run(cmdLine, stream, "show 0123456789\r");
+    CHECK("output", g_log == "show(show,0123456789) ");
+    CHECK("output", stream.Output() == "");
+    CHECK("output", queue.Queued() == 8);
+    CHECK("output", queue.Dropped() == 9);
+    stream.SetWriteRoom(-1);
+    CHECK("output", queue.Poll());
+    CHECK("output", stream.Output() == "show 012");
+
+    // the block policy: a full queue waits for the stream
+    queue.Policy(CMDLINE_OUTPUT_BLOCK);
+    stream.ClearOutput();
+    stream.SetWriteRoom(0);
+    Run(cmdLine, stream, "show 0123456789\r");
+    CHECK("output", stream.Output() == "show 0123456789\r");
+    CHECK("output", queue.Queued() == 1);
+    CHECK("output", queue.Dropped() == 9);
+    CHECK("output", !queue.Poll());
+    queue.Flush();
+    CHECK("output", stream.Output() == "show 0123456789\r\n");
+    CHECK("output", queue.Queued() == 0);
+}
+
+static void TestListing(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineOutputN<16> queue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetCommandTable(g_sHelpTable);
+    g_cmdLine = &cmdLine;
+    stream.Capture(true);
+
+    // one command per call (after the CR/LF of the command), the "show" command
+    // line waits for the listing
+    g_log.clear();
+    stream.SetInput("help\rshow a\r");
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", g_log == "help(help) ");
+    CHECK("listing", stream.Output() == "\r\n");
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", stream.Output() == "\r\nhelp - list\r\n");
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", stream.Output() == "\r\nhelp - list\r\nshow <args...>\r\n");
+    CHECK("listing", g_log == "help(help) ");
+    CHECK("listing", cmdLine.DoCmdLine() == 1);
+    CHECK("listing", cmdLine.DoCmdLine() == 1);
+    CHECK("listing", g_log == "help(help) show(show,a) ");
+
+    // with an output queue, as many commands as it has room for
+    cmdLine.SetOutput(queue);
+    stream.ClearOutput();
+    stream.SetWriteRoom(0);
+    g_log.clear();
+    stream.SetInput("help\r");
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", queue.Queued() == 15);
+    CHECK("listing", cmdLine.DoCmdLine() == 0);
+    CHECK("listing", queue.Queued() == 15);
+    stream.SetWriteRoom(-1);
+    CHECK("listing", cmdLine.DoCmdLine() == 1);
+    CHECK("listing", queue.Poll());
+    CHECK("listing", stream.Output() == "\r\nhelp - list\r\nshow <args...>\r\n");
+    CHECK("listing", g_log == "help(help) ");
+}
+
+static void TestPending(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineQueueN<4> lineQueue;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetCommandTable(g_sPendingTable);
+    g_cmdLine = &cmdLine;
+
+    // called again on each call until it is done, the next command line waits for it
+    g_log.clear();
+    stream.SetInput("wait a\rshow b\r");
+    CHECK("pending", cmdLine.DoCmdLine() == 0);
+    CHECK("pending", cmdLine.DoCmdLine() == 0);
+    CHECK("pending", cmdLine.DoCmdLine() == 0);
+    CHECK("pending", g_log == "");
+    CHECK("pending", cmdLine.DoCmdLine() == 1);
+    CHECK("pending", g_log == "wait(wait,a) ");
+    CHECK("pending", cmdLine.DoCmdLine() == 1);
+    CHECK("pending", g_log == "wait(wait,a) show(show,b) ");
+
+    // the argument values on each call, and the default handler in progress
+    Run(cmdLine, stream, "count 3\r");
+    CHECK("pending", g_log == "3 3 3 ");
+    cmdLine.SetDefaultHandler(Cmd_wait);
+    Run(cmdLine, stream, "nope x\rshow c\r");
+    CHECK("pending", g_log == "wait(nope,x) show(show,c) ");
+
+    // a Ctrl-C aborts it (the type-ahead before the Ctrl-C is dropped)
+    Run(cmdLine, stream, "busy\rshow d\r\x03show e\r");
+    CHECK("pending", g_log == "busy(busy) aborted(busy) E-6 show(show,e) ");
+
+    // the rest of its batch (with another command in progress) runs after it
+    cmdLine.BatchSeparator(';');
+    Run(cmdLine, stream, "wait;show f;count 2;show g\r");
+    CHECK("pending", g_log == "wait(wait) show(show,f) 2 2 show(show,g) ");
+
+    // its command line stays in the line queue
+    CHECK("pending", cmdLine.SetLineQueue(lineQueue));
+    Run(cmdLine, stream, "count 2;show h\rwait\rshow i\r");
+    CHECK("pending", g_log == "2 2 show(show,h) wait(wait) show(show,i) ");
+    CHECK("pending", lineQueue.Count() == 0);
+}
+
+static void TestBreak(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineOutputN<16> queue;
+    std::string typeAhead(3 * CMDLINE_RX_CHUNK, 'x');
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetCommandTable(g_sPendingTable);
+    g_cmdLine = &cmdLine;
+    stream.Capture(true);
+
+    // the break character after more than a chunk of type-ahead
+    Run(cmdLine, stream, "busy\r" + typeAhead + "\x03" + "show a\r");
+    CHECK("break", g_log == "busy(busy) aborted(busy) E-6 show(show,a) ");
+
+    // a listing is stopped
+    stream.ClearOutput();
+    Run(cmdLine, stream, "help\r\x03show b\r");
+    CHECK("break", g_log == "help(help) E-6 show(show,b) ");
+    CHECK("break", stream.Output().find("busy") == std::string::npos);
+
+    // the command line being typed is discarded (its echo up to the break character is kept)
+    cmdLine.Echo(true);
+    stream.ClearOutput();
+    Run(cmdLine, stream, "sho\x03show c\r");
+    CHECK("break", g_log == "show(show,c) ");
+    CHECK("break", stream.Output() == "sho^C\r\nshow c\r\n");
+
+    // the queued output is discarded
+    cmdLine.SetOutput(queue);
+    stream.SetWriteRoom(0);
+    Run(cmdLine, stream, "show d\r");
+    CHECK("break", queue.Queued() == 8);
+    Run(cmdLine, stream, "\x03");
+    CHECK("break", queue.Queued() == 4);
+    stream.SetWriteRoom(-1);
+    CHECK("break", queue.Poll());
+    cmdLine.Echo(false);
+
+    // without a break character, it is received like any other character
+    cmdLine.BreakChar(CMDLINE_NO_BREAK);
+    Run(cmdLine, stream, "wait\r\x03show e\r");
+    CHECK("break", g_log == "wait(wait) E-1 ");
+}
+
+// hands all of the input to Feed(), returns the number of characters taken
+static size_t Feed(CommandLineBase& cmdLine, const std::string& input)
+{
+    g_log.clear();
+    return cmdLine.Feed((const uint8_t *)input.data(), input.size());
+}
+
+static void TestFeed(void)
+{
+    MockStream out;
+    MockStream other;
+    CommandLine cmdLine(static_cast<Print&>(out), true);   // no input stream
+    CmdLineOutputN<16> queue;
+    CmdLineQueueN<2> lineQueue;
+    std::string input;
+    std::string longArg(2 * CMDLINE_RX_CHUNK, 'b');
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetCommandTable(g_sPendingTable);
+    g_cmdLine = &cmdLine;
+    out.Capture(true);
+    other.Capture(true);
+
+    // several command lines across receive chunks (one split between two calls), echoed to the output
+    input = "show a\rshow " + longArg + "\rsh";
+    CHECK("feed", Feed(cmdLine, input) == input.size());
+    CHECK("feed", g_log == "show(show,a) show(show," + longArg + ") ");
+    CHECK("feed", Feed(cmdLine, "ow c\r") == 5);
+    CHECK("feed", g_log == "show(show,c) ");
+    CHECK("feed", out.Output() == "show a\r\nshow " + longArg + "\r\nshow c\r\n");
+    CHECK("feed", cmdLine.DoCmdLine() == 0);    // (no input stream to poll)
+
+    // a command in progress: the rest of the receive chunk is processed after it, the
+    // rest of the characters are left to be fed again
+    cmdLine.Echo(false);
+    input = "count 2\rshow d\rshow e\r";
+    CHECK("feed", Feed(cmdLine, input) == CMDLINE_RX_CHUNK);
+    CHECK("feed", g_log == "2 ");
+    CHECK("feed", Feed(cmdLine, input.substr(CMDLINE_RX_CHUNK)) == 0);
+    CHECK("feed", cmdLine.DoCmdLine() == 1);
+    CHECK("feed", cmdLine.DoCmdLine() == 1);   // (and the "s" of "show e" is received)
+    CHECK("feed", g_log == "2 show(show,d) ");
+    CHECK("feed", Feed(cmdLine, input.substr(CMDLINE_RX_CHUNK)) == 6);
+    CHECK("feed", g_log == "show(show,e) ");
+
+    // the break character, in the receive chunk and in the rest of the characters
+    CHECK("feed", Feed(cmdLine, "busy\rxxxx\x03show f\r") == 17);
+    CHECK("feed", g_log == "busy(busy) aborted(busy) E-6 show(show,f) ");
+    input = "busy\r" + longArg + "\x03show g\r";
+    CHECK("feed", Feed(cmdLine, input) == input.size());
+    CHECK("feed", g_log == "busy(busy) aborted(busy) E-6 show(show,g) ");
+
+    // the rest of a batch runs after its command in progress (there is a line queue, but
+    // the command line is not in it)
+    cmdLine.BatchSeparator(';');
+    CHECK("feed", cmdLine.SetLineQueue(lineQueue));
+    CHECK("feed", Feed(cmdLine, "count 2;show h\r") == 15);
+    CHECK("feed", cmdLine.DoCmdLine() == 1);
+    CHECK("feed", g_log == "2 2 show(show,h) ");
+    CHECK("feed", lineQueue.Count() == 0);
+
+    // the output moved to another Print, and behind an output queue
+    cmdLine.Echo(true);
+    out.ClearOutput();
+    cmdLine.SetOutput(other);
+    Feed(cmdLine, "show i\r");
+    CHECK("feed", other.Output() == "show i\r\n");
+    cmdLine.SetOutput(queue);
+    cmdLine.SetOutput(out);
+    CHECK("feed", &queue.Sink() == &out);
+    CHECK("feed", &cmdLine.Output() == &queue);
+    Feed(cmdLine, "show j\r");
+    CHECK("feed", out.Output() == "show j\r\n");
+    CHECK("feed", other.Output() == "show i\r\n");
+}
+
+static void TestTee(void)
+{
+    MockStream in;
+    MockStream a;
+    MockStream b;
+    MockStream c;
+    CmdLineTeeN<2> tee;
+    CmdLineTeeN<1> none;
+    CmdLineOutputN<16> queue;
+    CommandLine cmdLine(in, tee);
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.SetCommandTable(g_sPendingTable);
+    a.Capture(true);
+    b.Capture(true);
+
+    CHECK("tee", none.write('x') == 0);
+    CHECK("tee", none.availableForWrite() == 0);
+    CHECK("tee", tee.Add(a));
+    CHECK("tee", tee.Add(b));
+    CHECK("tee", !tee.Add(c));
+
+    // the echo and the command output go to each output (none to the input stream)
+    Run(cmdLine, in, "show a\r");
+    CHECK("tee", g_log == "show(show,a) ");
+    CHECK("tee", a.Output() == "show a\r\n");
+    CHECK("tee", b.Output() == a.Output());
+    CHECK("tee", in.OutCount() == 0);
+    CHECK("tee", &cmdLine.Output() == &tee);
+
+    // a write is passed on once to each output, the count is the first output's
+    a.ClearOutput();
+    b.ClearOutput();
+    CHECK("tee", tee.write((const uint8_t *)"xyz", 3) == 3);
+    CHECK("tee", (a.WriteCalls() == 1) && (b.WriteCalls() == 1));
+    CHECK("tee", b.Output() == "xyz");
+
+    // the room for output is the least room of the outputs
+    a.SetWriteRoom(5);
+    b.SetWriteRoom(3);
+    CHECK("tee", tee.availableForWrite() == 3);
+    b.SetWriteRoom(-1);
+    CHECK("tee", tee.availableForWrite() == 5);
+
+    // an output queue in front of it waits for the output with no room
+    a.SetWriteRoom(-1);
+    b.SetWriteRoom(0);
+    a.ClearOutput();
+    b.ClearOutput();
+    cmdLine.SetOutput(queue);
+    CHECK("tee", &queue.Sink() == &tee);
+    Run(cmdLine, in, "show b\r");
+    CHECK("tee", g_log == "show(show,b) ");
+    CHECK("tee", a.Output() == "");
+    CHECK("tee", queue.Queued() == 8);
+    b.SetWriteRoom(-1);
+    cmdLine.DoCmdLine();
+    CHECK("tee", queue.Queued() == 0);
+    CHECK("tee", a.Output() == "show b\r\n");
+    CHECK("tee", b.Output() == a.Output());
+}
+
+// runs the input through a small command line (split as it is received, or by
+// the whole-line split with a line queue), with or without a hash index
+static std::string Args(bool lineQueue, bool hashIndex, const std::string& input)
+{
+    MockStream stream;
+    CommandLineN<24, 4> cmdLine(stream, false);
+    CmdLineQueueN<4, 24> queue;
+    CmdLineHashIndexN<8> index;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    g_cmdLine = &cmdLine;
+
+    if (lineQueue)
+    {
+        cmdLine.SetLineQueue(queue);
+    }
+    if (hashIndex)
+    {
+        cmdLine.SetHashIndex(index);
+    }
+    Run(cmdLine, stream, input);
+    return g_log;
+}
+
+static void TestArgs(void)
+{
+    static const struct
+    {
+        const char * input;
+        const char * log;
+    } cases[] =
+    {
+        { "show a b\r", "show(show,a,b) " },
+        { "  show   a  b  \r", "show(show,a,b) " },
+        { "nope x\r", "E-1 " },
+        // backspaces: in the name, over the whole name, over delimiters, before anything
+        { "shox\bw a\r", "show(show,a) " },
+        { "x y\b\b\bshow z\r", "show(show,z) " },
+        { "show\b\b\b\bset 5 on\r", "set(set,5,on) 5d,0d " },
+        { "show a  \b\bb\r", "show(show,ab) " },
+        { "show ab\b\b c\r", "show(show,c) " },
+        { "\b\bshow a\r", "show(show,a) " },
+        // the most arguments, one too many, and one too many backspaced
+        { "show a b c\r", "show(show,a,b,c) " },
+        { "show a b c d\r", "E-2 " },
+        { "show a b c d\b\b\r", "show(show,a,b,c) " },
+        // a full command line buffer ends the command line
+        { "show aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r", "show(show,aaaaaaaaaaaaaaaaaa) E-1 " },
+        { "show a b c d e f g h i j k l\r", "E-2 E-1 " },
+    };
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.SetCustomErrorHandler(LogErr);
+
+    for (size_t i = 0; i < (sizeof(cases) / sizeof(cases[0])); ++i)
+    {
+        for (int mode = 0; mode < 4; ++mode)
+        {
+            if (Args((mode & 1) != 0, (mode & 2) != 0, cases[i].input) != cases[i].log)
+            {
+                printf("args: \"%s\" (line queue %d, hash index %d): %s\n", cases[i].input, mode & 1,
+                       (mode >> 1) & 1, g_log.c_str());
+                ++g_fails;
+            }
+        }
+    }
+
+    // a delimiter changed mid-line (the line is scanned with the new one)
+    cmdLine.SetDefaultHandler(Cmd_show);
+    g_log.clear();
+    stream.SetInput("show a,b");
+    cmdLine.DoCmdLine();
+    cmdLine.Delimiter(',');
+    stream.SetInput(",c\r");
+    cmdLine.DoCmdLine();
+    CHECK("args", g_log == "show(show a,b,c) ");
+}
+
+int main(void)
+{
+    TestDispatch();
+    TestSplit();
+    TestEcho();
+    TestHash();
+    TestTables();
+    TestMux();
+    TestQueue();
+    TestBudget();
+    TestSchema();
+    TestBinary();
+    TestFraming();
+    TestBatch();
+    TestParse();
+    TestSizes();
+    TestOutput();
+    TestListing();
+    TestPending();
+    TestBreak();
+    TestFeed();
+    TestTee();
+    TestArgs();
+
+    printf("%s\n", (g_fails == 0) ? "PASS" : "FAIL");
+    return (g_fails == 0) ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+/*
+ * NAME: feature_test.cpp
+ *
+ * WHAT:
+ *  Host (Linux) tests of the optional (compile time) features of the
+ *  CommandLine library, built with the feature flags set (see the Makefile):
+ *   - stats (CMDLINE_STATS): the call counts, min/max/total execution times
+ *     and histogram buckets of the timed commands, the built-in "stats"
+ *     command ("stats clear"), a table's own "stats" command, and commands
+ *     past the end of the statistics storage
+ *   - counters (CMDLINE_COUNTERS): the bytes received and echoed, the lines,
+ *     overflows, backspaces, unknown commands and the longest line, the
+ *     built-in "counters" command ("counters clear"), the same counts for the
+ *     characters handed over with Feed(), and the type-ahead dropped before a
+ *     break character is not counted (on either path)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The feature flags change the CommandLine class layout, so this program and
+ *  the library object it is linked with must both be built with them.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <string>
+
+#include "Arduino.h"
+#include "CommandLine.h"
+#include "MockStream.h"
+
+#if !CMDLINE_STATS || !CMDLINE_COUNTERS
+#error "feature_test must be built with the feature flags set"
+#endif
+
+static uint32_t g_fails;
+
+#define CHECK(test, cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            printf("%s: check failed at line %d: %s (log: %s)\n", (test), __LINE__, #cond, g_log.c_str()); \
+            ++g_fails; \
+        } \
+    } while (0)
+
+// the command calls and reported errors, as text
+static std::string g_log;
+
+static void LogErr(int8_t err_code)
+{
+    if (err_code != 0)
+    {
+        g_log += "E" + std::to_string(err_code) + " ";
+    }
+}
+
+// "fast" - logs its call
+static int8_t Cmd_fast(int8_t argc, char * argv[])
+{
+    (void)argc;
+    g_log += argv[0];
+    g_log += " ";
+    return 0;
+}
+
+// "slow" - logs its call and takes 2 ms
+static int8_t Cmd_slow(int8_t argc, char * argv[])
+{
+    unsigned long start = micros();
+
+    Cmd_fast(argc, argv);
+    while ((micros() - start) < 2000)
+    {
+    }
+    return 0;
+}
+
+// the command line of the command being executed
+static CommandLineBase * g_cmdLine;
+
+// "busy" - logs its call, in progress until aborted
+static int8_t Cmd_busy(int8_t argc, char * argv[])
+{
+    if (g_cmdLine->CmdAborted())
+    {
+        return CMDLINE_ABORTED;
+    }
+    if (g_cmdLine->CmdState()++ == 0)
+    {
+        Cmd_fast(argc, argv);
+    }
+    return CMDLINE_PENDING;
+}
+
+const tCmdLineEntry g_sCmdTable[] PROGMEM =
+{
+    { "fast", Cmd_fast, "", NULL },
+    { "slow", Cmd_slow, "", NULL },
+    { "late", Cmd_fast, "", NULL },
+    { "busy", Cmd_busy, "", NULL },
+    { 0, 0, 0, 0 }
+};
+
+const tCmdLineEntry g_sStatsTable[] PROGMEM =
+{
+    { "stats", Cmd_fast, "", NULL },
+};
+
+// runs all of the input through DoCmdLine()
+static void Run(CommandLine& cmdLine, MockStream& stream, const char * input)
+{
+    g_log.clear();
+    stream.SetInput(input);
+    for (int i = 0; i < 100; ++i)
+    {
+        cmdLine.DoCmdLine();
+    }
+}
+
+static void TestStats(void)
+{
+    const char * test = "stats";
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CmdLineStatsN<2> stats;         // "late" is past the end of the storage
+    const tCmdLineStat * pStat;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    stream.Capture(true);
+
+    CHECK(test, CmdLineStats::Bucket(0) == 0);
+    CHECK(test, CmdLineStats::Bucket(3) == 0);
+    CHECK(test, CmdLineStats::Bucket(4) == 1);
+    CHECK(test, CmdLineStats::Bucket(15) == 1);
+    CHECK(test, CmdLineStats::Bucket(16) == 2);
+    CHECK(test, CmdLineStats::Bucket(16383) == 6);
+    CHECK(test, CmdLineStats::Bucket(16384) == 7);
+    CHECK(test, CmdLineStats::Bucket(0xffffffff) == 7);
+
+    // without statistics, "stats" is not a command
+    Run(cmdLine, stream, "stats\r");
+    CHECK(test, g_log == "E-1 ");
+
+    cmdLine.SetStats(stats);
+    Run(cmdLine, stream, "fast\rslow\rfast\rlate\r");
+    CHECK(test, g_log == "fast slow fast late ");
+
+    pStat = stats.Entry(0);
+    CHECK(test, (pStat != NULL) && (pStat->count == 2));
+    CHECK(test, (pStat != NULL) && (pStat->minMicros <= pStat->maxMicros));
+    CHECK(test, (pStat != NULL) && (pStat->totalMicros >= pStat->maxMicros));
+    pStat = stats.Entry(1);
+    CHECK(test, (pStat != NULL) && (pStat->count == 1));
+    CHECK(test, (pStat != NULL) && (pStat->minMicros >= 2000) && (pStat->minMicros == pStat->maxMicros));
+    CHECK(test, (pStat != NULL) && (pStat->hist[CmdLineStats::Bucket(pStat->maxMicros)] == 1));
+    CHECK(test, stats.Entry(2) == NULL);
+
+    // the built-in command lists the called commands only
+    stream.ClearOutput();
+    Run(cmdLine, stream, "stats\r");
+    CHECK(test, g_log == "");
+    CHECK(test, stream.Output().find("fast: 2 ") != std::string::npos);
+    CHECK(test, stream.Output().find("slow: 1 ") != std::string::npos);
+    CHECK(test, stream.Output().find("late") == std::string::npos);
+
+    Run(cmdLine, stream, "STATS clear\r");
+    CHECK(test, stats.Entry(0)->count == 0);
+    CHECK(test, stats.Entry(1)->count == 0);
+    CHECK(test, stats.Entry(1)->maxMicros == 0);
+
+    // a table's own "stats" command takes precedence (and the new table clears them)
+    Run(cmdLine, stream, "fast\r");
+    CHECK(test, stats.Entry(0)->count == 1);
+    cmdLine.SetCommandTable(g_sStatsTable, 1);
+    CHECK(test, stats.Entry(0)->count == 0);
+    Run(cmdLine, stream, "stats\r");
+    CHECK(test, g_log == "stats ");
+    CHECK(test, stats.Entry(0)->count == 1);
+}
+
+static void TestCounters(void)
+{
+    const char * test = "counters";
+    MockStream stream;
+    CommandLine cmdLine(stream);
+    char longLine[200];
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.CrLfCommand(false);
+    stream.Capture(true);
+
+    const tCmdLineCounters& counters = cmdLine.Counters();
+    CHECK(test, counters.bytesIn == 0);
+    CHECK(test, counters.lines == 0);
+
+    // "fast", "fast" (with 2 backspaces), an unknown command
+    stream.ClearOutput();
+    Run(cmdLine, stream, "fast\rfaxx\b\bst\rnope\r");
+    CHECK(test, g_log == "fast fast E-1 ");
+    CHECK(test, counters.bytesIn == 19);
+    CHECK(test, counters.bytesEchoed == stream.OutCount());
+    CHECK(test, counters.lines == 3);
+    CHECK(test, counters.overflows == 0);
+    CHECK(test, counters.backspaces == 2);
+    CHECK(test, counters.badCmds == 1);
+    CHECK(test, counters.maxLineLen == 4);
+
+    // a command line too long for the buffer (a full buffer ends each part of it)
+    memset(longLine, 'x', sizeof(longLine) - 2);
+    longLine[sizeof(longLine) - 2] = '\r';
+    longLine[sizeof(longLine) - 1] = '\0';
+    Run(cmdLine, stream, longLine);
+    CHECK(test, counters.bytesIn == 19 + sizeof(longLine) - 1);
+    CHECK(test, counters.lines == 6);
+    CHECK(test, counters.overflows == 2);
+    CHECK(test, counters.badCmds == 4);
+    CHECK(test, counters.maxLineLen == CMD_BUF_SIZE - 1);
+
+    // the built-in command shows them (a line is counted when it returns), "counters clear" clears them
+    stream.ClearOutput();
+    Run(cmdLine, stream, "counters\r");
+    CHECK(test, g_log == "");
+    CHECK(test, stream.Output().find("lines: 6") != std::string::npos);
+    CHECK(test, stream.Output().find("bad commands: 4") != std::string::npos);
+    Run(cmdLine, stream, "Counters clear\r");
+    CHECK(test, counters.lines == 1);
+    CHECK(test, counters.badCmds == 0);
+    CHECK(test, counters.maxLineLen == 0);
+    cmdLine.ClearCounters();
+    CHECK(test, counters.bytesEchoed == 0);
+
+    // the type-ahead dropped before a break character is not counted
+    g_cmdLine = &cmdLine;
+    Run(cmdLine, stream, ("busy\r" + std::string(100, 'x') + "\x03" "fast\r").c_str());
+    CHECK(test, g_log == "busy E-6 fast ");
+    CHECK(test, counters.bytesIn == 11);
+}
+
+// hands all of the input to Feed()
+static void Feed(CommandLineBase& cmdLine, const std::string& input)
+{
+    g_log.clear();
+    cmdLine.Feed((const uint8_t *)input.data(), input.size());
+}
+
+static void TestFeedCounters(void)
+{
+    const char * test = "feed counters";
+    MockStream out;
+    CommandLine cmdLine(static_cast<Print&>(out), true);   // no input stream
+    cmdLine.SetCustomErrorHandler(LogErr);
+    cmdLine.CrLfCommand(false);
+    out.Capture(true);
+
+    // the same counts as through DoCmdLine()
+    const tCmdLineCounters& counters = cmdLine.Counters();
+    Feed(cmdLine, "fast\rfaxx\b\bst\rnope\r");
+    CHECK(test, g_log == "fast fast E-1 ");
+    CHECK(test, counters.bytesIn == 19);
+    CHECK(test, counters.bytesEchoed == out.OutCount());
+    CHECK(test, counters.lines == 3);
+    CHECK(test, counters.backspaces == 2);
+    CHECK(test, counters.badCmds == 1);
+    CHECK(test, counters.maxLineLen == 4);
+
+    // the type-ahead dropped before a break character is not counted
+    cmdLine.ClearCounters();
+    g_cmdLine = &cmdLine;
+    Feed(cmdLine, "busy\r" + std::string(100, 'x') + "\x03" "fast\r");
+    CHECK(test, g_log == "busy E-6 fast ");
+    CHECK(test, counters.bytesIn == 11);
+}
+
+int main(void)
+{
+    TestStats();
+    TestCounters();
+    TestFeedCounters();
+
+    printf("%s\n", (g_fails == 0) ? "PASS" : "FAIL");
+    return (g_fails == 0) ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+/*
+ * NAME: notable_test.cpp
+ *
+ * WHAT:
+ *  Host (Linux) test of a program that does not provide the default command
+ *  table (g_sCmdTable is declared weak).
+ *
+ *  A CommandLine without a command table reports every command as a bad
+ *  command (and lists no commands), a CommandLine with its own command table
+ *  dispatches from it.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Must not define g_sCmdTable (so it is a separate program from cmdline_test).
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <string>
+
+#include "Arduino.h"
+#include "CommandLine.h"
+#include "MockStream.h"
+
+static uint32_t g_fails;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            printf("notable: check failed at line %d: %s (log: %s)\n", __LINE__, #cond, g_log.c_str()); \
+            ++g_fails; \
+        } \
+    } while (0)
+
+// the command calls and reported errors, as text
+static std::string g_log;
+
+static void LogErr(int8_t err_code)
+{
+    if (err_code != 0)
+    {
+        g_log += "E" + std::to_string(err_code) + " ";
+    }
+}
+
+// "own" - logs its call
+static int8_t Cmd_own(int8_t argc, char * argv[])
+{
+    (void)argc;
+    g_log += argv[0];
+    g_log += " ";
+    return 0;
+}
+
+const tCmdLineEntry g_sOwnTable[] PROGMEM =
+{
+    { "own", Cmd_own, "", NULL },
+};
+
+// runs all of the input through DoCmdLine()
+static void Run(CommandLine& cmdLine, MockStream& stream, const char * input)
+{
+    g_log.clear();
+    stream.SetInput(input);
+    for (int i = 0; i < 100; ++i)
+    {
+        cmdLine.DoCmdLine();
+    }
+}
+
+int main(void)
+{
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    CommandLine ownLine(stream, g_sOwnTable);
+    CmdLineHashIndexN<4> index;
+    cmdLine.SetCustomErrorHandler(LogErr);
+    ownLine.SetCustomErrorHandler(LogErr);
+    ownLine.Echo(false);
+
+    CHECK(g_sCmdTable == NULL);
+
+    Run(cmdLine, stream, "own\r");
+    CHECK(g_log == "E-1 ");
+    CHECK(!cmdLine.SetHashIndex(index));
+    Run(cmdLine, stream, "own\r");
+    CHECK(g_log == "E-1 ");
+
+    stream.ClearOutput();
+    cmdLine.ShowCommands();
+    CHECK(stream.OutCount() == 0);
+
+    Run(ownLine, stream, "own\r");
+    CHECK(g_log == "own ");
+
+    printf("%s\n", (g_fails == 0) ? "PASS" : "FAIL");
+    return (g_fails == 0) ? 0 : 1;
+}
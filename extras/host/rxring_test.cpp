@@ -0,0 +1,192 @@
+/*
+ * NAME: rxring_test.cpp
+ *
+ * WHAT:
+ *  Host (Linux) test of the lock-free receive ring (CmdLineRxRing).
+ *
+ *  A std::thread stands in for the interrupt handler (the producer) and feeds
+ *  the ring as fast as it can, while the main thread (the consumer) takes the
+ *  bytes out:
+ *   - raw: a pseudo-random byte sequence (single byte and block Put()) is
+ *     taken out with Get() and checked byte for byte
+ *   - command lines: numbered command lines are fed to a CommandLine (see
+ *     SetRxRing()) and the command checks that every line arrives, in order
+ *     and intact
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The producer waits (yields) while the ring is full, so every byte must
+ *  arrive - the overruns are only the times the ring was found full. Build
+ *  with -fsanitize=thread to also check for data races.
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Arduino.h"
+#include "CommandLine.h"
+#include "MockStream.h"
+
+#define TEST_RAW_BYTES      (16UL * 1024 * 1024)
+#define TEST_LINES          200000UL
+
+typedef std::chrono::steady_clock test_clock;
+
+static double ElapsedSec(test_clock::time_point start)
+{
+    return std::chrono::duration<double>(test_clock::now() - start).count();
+}
+
+// the pseudo-random test byte sequence (a 32-bit LCG, top byte)
+static uint8_t NextByte(uint32_t * seed)
+{
+    *seed = (*seed * 1664525UL) + 1013904223UL;
+    return (uint8_t)(*seed >> 24);
+}
+
+static bool TestRaw(void)
+{
+    static CmdLineRxRingN<64> ring;
+    uint32_t seed = 1;
+    uint32_t got = 0;
+    uint32_t bad = 0;
+    uint8_t buf[CMDLINE_RX_CHUNK];
+    uint16_t len;
+    test_clock::time_point start = test_clock::now();
+
+    std::thread producer([]()
+    {
+        uint32_t pseed = 1;
+        uint32_t sent = 0;
+        uint8_t block[7];
+        uint16_t n;
+        uint16_t done;
+
+        while (sent < TEST_RAW_BYTES)
+        {
+            if (sent & 0x100)
+            {
+                // a block (as from a DMA callback)
+                n = (uint16_t)(((TEST_RAW_BYTES - sent) < sizeof(block)) ? (TEST_RAW_BYTES - sent) : sizeof(block));
+                for (uint16_t i = 0; i < n; ++i)
+                {
+                    block[i] = NextByte(&pseed);
+                }
+                for (done = 0; done < n; done += ring.Put(&block[done], n - done))
+                {
+                    std::this_thread::yield();
+                }
+                sent += n;
+            }
+            else
+            {
+                // a byte (as from a UART receive interrupt)
+                uint8_t ch = NextByte(&pseed);
+                while (!ring.Put(ch))
+                {
+                    std::this_thread::yield();
+                }
+                ++sent;
+            }
+        }
+    });
+
+    while (got < TEST_RAW_BYTES)
+    {
+        len = ring.Get(buf, sizeof(buf));
+        if (len == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (uint16_t i = 0; i < len; ++i)
+        {
+            if (buf[i] != NextByte(&seed))
+            {
+                ++bad;
+            }
+        }
+        got += len;
+    }
+    producer.join();
+
+    printf("raw:   %lu bytes, %lu bad, %lu ring full, %.1f MB/s\n",
+           (unsigned long)got, (unsigned long)bad, (unsigned long)ring.Overruns(),
+           got / ElapsedSec(start) / 1e6);
+    return (bad == 0) && (ring.Available() == 0);
+}
+
+static uint32_t g_expect;
+static uint32_t g_bad;
+
+// "n <line number>"
+static int8_t Cmd_n(int8_t argc, char * argv[])
+{
+    if ((argc != 2) || (strtoul(argv[1], NULL, 10) != g_expect))
+    {
+        ++g_bad;
+    }
+    ++g_expect;
+    return 0;
+}
+
+const tCmdLineEntry g_sCmdTable[] PROGMEM =
+{
+    { "n", Cmd_n, " <line number>", NULL },
+    { 0, 0, 0, 0 }  // end of commands
+};
+
+static bool TestLines(void)
+{
+    static CmdLineRxRingN<256> ring;
+    test_clock::time_point start = test_clock::now();
+
+    MockStream stream;
+    CommandLine cmdLine(stream, false);
+    cmdLine.CrLfCommand(false);
+    cmdLine.SetRxRing(ring);
+
+    std::thread producer([]()
+    {
+        char line[16];
+        int len;
+
+        for (uint32_t i = 0; i < TEST_LINES; ++i)
+        {
+            len = snprintf(line, sizeof(line), "n %lu\r", (unsigned long)i);
+            for (int pos = 0; pos < len; ++pos)
+            {
+                while (!ring.Put((uint8_t)line[pos]))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    while (g_expect < TEST_LINES)
+    {
+        if (!cmdLine.DoCmdLine())
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    printf("lines: %lu lines, %lu bad, %lu ring full, %.0f lines/s\n",
+           (unsigned long)g_expect, (unsigned long)g_bad, (unsigned long)ring.Overruns(),
+           g_expect / ElapsedSec(start));
+    return (g_bad == 0) && (stream.OutCount() == 0);
+}
+
+int main(void)
+{
+    bool pass = TestRaw();
+
+    pass = TestLines() && pass;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
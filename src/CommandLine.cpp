@@ -34,20 +34,211 @@
  *    - added initial Raspberry Pi Pico support
  *  7/7/2023: "V1.10 7/7/2023"
  *    - added support for 9 parameters
+ *  10/16/2026: "V1.11 10/16/2026"
+ *    - added optional hash index for constant time command lookup
+ *    - receive characters a chunk at a time (one available() call per chunk)
+ *    - echo characters with one write per DoCmdLine() call (or per command line)
+ *    - added per-instance command tables (g_sCmdTable is the default)
+ *    - added DoCmdLine() limit on the received characters processed per call
+ *    - added CommandLineMux for round-robin servicing of several command lines
+ *    - added optional queue of received command lines (pipelined commands)
+ *    - added DoCmdLine() time budget (work left over is resumed by the next call)
+ *    - added optional command argument schema (arguments checked/converted before dispatch)
+ *    - rewrote ParseParam() as a linear parser with overflow detection, added uint32_t/int64_t versions
+ *    - added binary framing mode (length-prefixed frames with CRC-8, see FrameMode())
+ *    - added SLIP and COBS framing modes (8-bit clean command lines, except for 0x00)
+ *    - added command batches (several commands in one command line, see BatchSeparator())
+ *    - added optional per-command execution time statistics (CMDLINE_STATS, see SetStats())
+ *    - added optional receive path counters (CMDLINE_COUNTERS, see Counters())
+ *    - command line buffers sized at compile time per instance (CommandLineN<BufSize, MaxArgs,
+ *      MaxTerminators>, CommandLine is the default sizes), echo written from the receive chunk
+ *    - added optional non-blocking output queue (see SetOutput())
+ *    - added resumable command listing (see ShowCommandsAsync())
+ *    - added long-running commands (CMDLINE_PENDING, see CmdState()), aborted by Ctrl-C
+ *    - added break character that cancels queued output, listings and commands (see BreakChar())
+ *    - added optional lock-free receive ring fed by an interrupt handler (see SetRxRing())
+ *    - added Feed() for received characters handed over by the caller, and a separate output
+ *      (see SetOutput(Print&), CommandLineN(Print&, bool) has no input stream)
+ *    - added separate input and output constructor (CommandLineN(Stream& in, Print& out)) and
+ *      output mirror to several outputs (see CmdLineTee)
+ *    - command name hash (with a hash index) computed as the characters are received
+ *    - command line split into arguments as the characters are received
  */
 
 #include "Arduino.h"
 #include "CommandLine.h"
 
+//
+// Binary frame receive states.
+//
+#define FRAME_SYNC      0       // waiting for the SYNC byte
+#define FRAME_LEN       1       // waiting for the LEN byte
+#define FRAME_DATA      2       // receiving the command id and args bytes
+#define FRAME_CRC       3       // waiting for the CRC-8 byte
+#define FRAME_ESC       4       // SLIP escape received
+#define FRAME_DROP      5       // dropping a bad SLIP/COBS frame (until the next delimiter)
+
+// the command table entry of a command in progress that is the default handler
+#define PENDING_DEFAULT 0xffff
+
+// counts a receive path event (see tCmdLineCounters)
+#if CMDLINE_COUNTERS
+#define CMDLINE_COUNT(counter)      (++counters.counter)
+#else
+#define CMDLINE_COUNT(counter)
+#endif
+
+//
+// The command name of a binary frame is copied into the command line buffer
+// where the command table strings can not be read in place (AVR Flash, and
+// ESP8266 Flash which needs aligned reads).
+//
+#if !defined(CMDLINE_FRAME_NAME_COPY)
+#if defined(__AVR__) || defined(ESP8266)
+#define CMDLINE_FRAME_NAME_COPY     1
+#else
+#define CMDLINE_FRAME_NAME_COPY     0
+#endif
+#endif
+
+//
+// Command table (Flash) entry access.
+//
+
+// returns the command name of a command table entry
+static PGM_P EntryCmd(const tCmdLineEntry * pEntry)
+{
+#ifdef ESP8266
+    PGM_P const * pgmp = &(pEntry->pcCmd);    // prevents dereferencing type-punned pointer warning
+    return (PGM_P)pgm_read_dword(pgmp);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pEntry->pcCmd;
+#else
+    return (PGM_P)pgm_read_word(&pEntry->pcCmd);
+#endif
+}
+
+// returns the command function of a command table entry
+static pfnCmdLine EntryFunc(const tCmdLineEntry * pEntry)
+{
+#ifdef ESP8266
+    const pfnCmdLine * pfn = &(pEntry->pfnCmd);    // prevents dereferencing type-punned pointer warning
+    return (pfnCmdLine)pgm_read_dword(pfn);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pEntry->pfnCmd;
+#else
+    return (pfnCmdLine)pgm_read_word(&pEntry->pfnCmd);
+#endif
+}
+
+// returns the help string of a command table entry
+static PGM_P EntryHelp(const tCmdLineEntry * pEntry)
+{
+#ifdef ESP8266
+    PGM_P const * pgmp = &(pEntry->pcHelp);   // prevents dereferencing type-punned pointer warning
+    return (PGM_P)pgm_read_dword(pgmp);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pEntry->pcHelp;
+#else
+    return (PGM_P)pgm_read_word(&pEntry->pcHelp);
+#endif
+}
+
+// returns the argument schema of a command table entry
+static const tCmdLineArgs * EntryArgs(const tCmdLineEntry * pEntry)
+{
+#ifdef ESP8266
+    const tCmdLineArgs * const * pgmp = &(pEntry->pArgs);   // prevents dereferencing type-punned pointer warning
+    return (const tCmdLineArgs *)pgm_read_dword(pgmp);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pEntry->pArgs;
+#else
+    return (const tCmdLineArgs *)pgm_read_word(&pEntry->pArgs);
+#endif
+}
+
+// returns the argument types of a command argument schema
+static const uint8_t * ArgsTypes(const tCmdLineArgs * pArgs)
+{
+#ifdef ESP8266
+    const uint8_t * const * pgmp = &(pArgs->types);     // prevents dereferencing type-punned pointer warning
+    return (const uint8_t *)pgm_read_dword(pgmp);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pArgs->types;
+#else
+    return (const uint8_t *)pgm_read_word(&pArgs->types);
+#endif
+}
+
+// returns the keywords string of a command argument schema
+static PGM_P ArgsKeywords(const tCmdLineArgs * pArgs)
+{
+#ifdef ESP8266
+    PGM_P const * pgmp = &(pArgs->pcKeywords);  // prevents dereferencing type-punned pointer warning
+    return (PGM_P)pgm_read_dword(pgmp);
+#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
+    return pArgs->pcKeywords;
+#else
+    return (PGM_P)pgm_read_word(&pArgs->pcKeywords);
+#endif
+}
+
+// returns the index of an argument (case-insensitive) in a keywords string ("on|off|hb"), -1 if not found
+static int8_t FindKeyword(PGM_P pcKeywords, const char * arg)
+{
+    const char * pc = arg;
+    int8_t idx = 0;
+    bool match = true;
+    char ch;
+
+    if (pcKeywords == NULL)
+    {
+        return -1;
+    }
+    do
+    {
+        ch = (char)pgm_read_byte(pcKeywords++);
+        if ((ch == '\0') || (ch == CMDLINE_KEYWORD_SEP))
+        {
+            if (match && (*pc == '\0'))
+            {
+                return idx;
+            }
+            ++idx;
+            pc = arg;
+            match = true;
+        }
+        else if (match && (tolower((int)ch) == tolower((int)*pc)))
+        {
+            ++pc;
+        }
+        else
+        {
+            match = false;
+        }
+    } while (ch != '\0');
+    return -1;
+}
+
 /*
  * NAME:
- *  CommandLine(Stream& _serial)
+ *  CommandLineBase(Stream * _serial, Print& out, char ** buffers, uint16_t bufSize, uint8_t _maxArgs,
+ *                  uint8_t _maxTerminators)
  *
  * PARAMETERS:
- *  Stream& _serial = the stream that a command line is implemented on (typically 'Serial')
+ *  Stream * _serial = the stream that a command line is implemented on (typically 'Serial'),
+ *                     NULL = none (the input is fed with Feed())
+ *  Print& out = where the command line output is written
+ *  char ** buffers = the command line buffers (laid out as a CmdLineBuffers: argv[_maxArgs],
+ *                    the argument values[_maxArgs], the command line buffer[bufSize], the
+ *                    terminators[_maxTerminators + 1] and the argument hex flags)
+ *  uint16_t bufSize = the size of the command line buffer
+ *  uint8_t _maxArgs = the maximum number of arguments that can be parsed
+ *  uint8_t _maxTerminators = the maximum number of command line terminators
  *
  * WHAT:
- *  A constructor that sets up the command line processing code.
+ *  A constructor that sets up the command line processing code on its command
+ *  line buffers (which are sized at compile time by CommandLineN).
  *
  * RETURN VALUES:
  *  None.
@@ -55,598 +246,3875 @@
  * SPECIAL CONSIDERATIONS:
  *  Defaults to enable echo of incoming characters.
  */
-CommandLine::CommandLine(Stream& _serial) : CommandLine::CommandLine(_serial, true)
+CommandLineBase::CommandLineBase(Stream * _serial, Print& out, char ** buffers, uint16_t bufSize, uint8_t _maxArgs,
+                                 uint8_t _maxTerminators) :
+    output(&out), argv(buffers), maxArgs(_maxArgs), maxTerminators(_maxTerminators)
+{
+    source.serial = _serial;
+    input.fromRing = false;             // default is read from the stream (changed with SetRxRing())
+    input.bufSize = bufSize;
+    SetDefaults(true);
+}
+
+// Sets the operating defaults.
+void CommandLineBase::SetDefaults(bool _echoEnable)
 {
-    // uses other constructor for initialization using "constructor delegation"
+    input.echoEnable = _echoEnable;     // specified incoming character echo (changed with Echo())
+    input.crLfechoEnable = false;       // default CR/LF echo is off         (changed with CrLfEcho())
+    input.crLfcmdEnable = true ;        // default sending CR/LF is on       (changed with CrLfCommand())
+    input.breakChar = CHAR_CTRL_C;      // default break character is Ctrl-C (changed with BreakChar())
+    delimiter = ' ';                    // default parameter delimiter       (changed with Delimiter())
+    memset(TermChars(), 0, maxTerminators + 1);
+    TermChars()[0] = '\r';              // default command line terminator   (changed with Terminators())
+    defaultFunc = NULL;                 // default unknown command handler is none (changed with SetDefaultHandler())
+    errorFunc = NULL;                   // default command error handler is none (changed with SetCustomErrorHandler())
+    cmdTable = g_sCmdTable;             // default command table                (changed with SetCommandTable())
+    numCmds = CMDLINE_TABLE_UNSIZED;
+    hashIndex = NULL;                   // default command lookup is linear search (changed with SetHashIndex())
+    lineQueue = NULL;                   // default is no received command line queue (changed with SetLineQueue())
+    input.outQueued = false;            // default is no output queue (changed with SetOutput())
+    argsValid = false;
+    pending.state = 0;
+    pending.rest = 0;
+    pending.queued = false;
+#if CMDLINE_STATS
+    stats = NULL;                       // default is no command statistics (changed with SetStats())
+#endif
+#if CMDLINE_COUNTERS
+    ClearCounters();
+#endif
+    work.timed = false;
+    work.lineReady = false;
+    work.statusPending = false;
+    work.showing = false;
+    work.pending = false;
+    work.aborted = false;
+    frame.mode = CMDLINE_FRAME_TEXT;    // default is the text console (changed with FrameMode())
+    frame.state = FRAME_SYNC;
+    frame.code = 0;
+    frame.left = 0;
+    frame.reply = false;
+    batch.separator = CMDLINE_NO_BATCH; // default is no command batches (changed with BatchSeparator())
+    batch.stopOnError = true;
+    NewLine();
+    rx.pos = 0;
+    rx.len = 0;
+    rx.echo = 0;
 }
 
 /*
  * NAME:
- *  CommandLine(Stream& _serial, bool _echoEnable)
+ *  int8_t DoCmdLine(void)
  *
  * PARAMETERS:
- *  Stream& _serial = the stream that a command line is implemented on (typically 'Serial')
- *  bool _echoEnable = a flag that is used to enable/disable echo of incoming characters
- *                     (true = enable echo, false = disable echo)
+ *  None.
  *
  * WHAT:
- *  A constructor that sets up the command line processing code.
+ *  Implements the non-blocking serial command processing.
  *
  * RETURN VALUES:
- *  None.
+ *  int8_t = 0 = no command to process yet
+ *           1 = a command was processed
  *
  * SPECIAL CONSIDERATIONS:
- *  None.
+ *  This should be called in 'loop' to check for/process incoming commands.
  */
-CommandLine::CommandLine(Stream& _serial, bool _echoEnable) : serial(_serial)
+int8_t CommandLineBase::DoCmdLine(void)
 {
-    SetDefaults(_echoEnable);
+    return DoCmdLine(CMDLINE_NO_LIMIT, CMDLINE_NO_TIME_LIMIT);
 }
 
-// Sets the operating defaults.
-void CommandLine::SetDefaults(bool _echoEnable)
+/*
+ * NAME:
+ *  int8_t DoCmdLine(uint16_t maxChars)
+ *
+ * PARAMETERS:
+ *  uint16_t maxChars = the maximum number of received characters to process
+ *
+ * WHAT:
+ *  Implements the non-blocking serial command processing, processing no more
+ *  than 'maxChars' received characters.
+ *
+ * RETURN VALUES:
+ *  int8_t = 0 = no command to process yet
+ *           1 = a command was processed
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Any further received characters are processed by the next call.
+ */
+int8_t CommandLineBase::DoCmdLine(uint16_t maxChars)
 {
-    input.echoEnable = _echoEnable;     // specified incoming character echo (changed with Echo())
-    input.crLfechoEnable = false;       // default CR/LF echo is off         (changed with CrLfEcho())
-    input.crLfcmdEnable = true ;        // default sending CR/LF is on       (changed with CrLfCommand())
-    delimiter = ' ';                    // default parameter delimiter       (changed with Delimiter())
-    strcpy(terminators, "\r");          // default command line terminator   (changed with Terminators())
-    defaultFunc = NULL;                 // default unknown command handler is none (changed with SetDefaultHandler())
-    errorFunc = NULL;                   // default command error handler is none (changed with SetCustomErrorHandler())
-    input.index = 0;
+    return DoCmdLine(maxChars, CMDLINE_NO_TIME_LIMIT);
 }
 
 /*
  * NAME:
- *  int8_t DoCmdLine(void)
+ *  int8_t DoCmdLine(uint16_t maxChars, uint32_t maxMicros)
  *
  * PARAMETERS:
- *  None.
+ *  uint16_t maxChars = the maximum number of received characters to process
+ *  uint32_t maxMicros = the time budget for the call in microseconds
+ *                       (CMDLINE_NO_TIME_LIMIT = no time limit)
  *
  * WHAT:
- *  Implements the non-blocking serial command processing.
+ *  Implements the non-blocking serial command processing, doing no more than
+ *  'maxChars' received characters and 'maxMicros' microseconds of work.
+ *
+ *  The work is done in steps - receiving a chunk of characters, executing a
+ *  command, reporting a command error - and the budget is checked after each
+ *  step. Work left when the budget runs out is resumed by the next call (a
+ *  received command line is executed, or an executed command's error is
+ *  reported, before any more characters are received).
  *
  * RETURN VALUES:
  *  int8_t = 0 = no command to process yet
  *           1 = a command was processed
  *
  * SPECIAL CONSIDERATIONS:
- *  This should be called in 'loop' to check for/process incoming commands.
+ *  At least one step is done per call, and the time taken by a command
+ *  function itself can not be limited. A budget over 0x7fffffff microseconds
+ *  (about 35 minutes) is cut to that.
  */
-int8_t CommandLine::DoCmdLine(void)
+int8_t CommandLineBase::DoCmdLine(uint16_t maxChars, uint32_t maxMicros)
 {
-    int nStatus;
-    char ch = '\0';
+    char ch;
+    int8_t processed = 0;
 
-    if (!serial.available())
+    work.timed = (maxMicros != CMDLINE_NO_TIME_LIMIT);
+    if (work.timed)
     {
-        return 0;       // no command to process yet
+        budgetEnd = micros() + ((maxMicros > 0x7fffffffUL) ? 0x7fffffffUL : maxMicros);
     }
-    else
+
+    //
+    // Write the queued output that the stream has room for.
+    //
+    if (input.outQueued)
+    {
+        static_cast<CmdLineOutput *>(output)->Poll();
+    }
+
+    //
+    // Continue a command listing (the command that started it is processed
+    // when the listing is done).
+    //
+    if (work.showing)
+    {
+        if ((frame.mode == CMDLINE_FRAME_TEXT) && RxBreak())
+        {
+            Cancel();
+            return 1;       // command processed (the listing is stopped)
+        }
+        if (ShowNext())
+        {
+            return 1;       // command processed
+        }
+        if (OutOfTime())
+        {
+            return processed;
+        }
+    }
+
+    //
+    // Report the error of a command executed by the last call.
+    //
+    if (work.statusPending)
+    {
+        work.statusPending = false;
+        ReportStatus(work.status);
+        if (OutOfTime())
+        {
+            return processed;
+        }
+    }
+
+    //
+    // Call the command in progress again (its command line stays in the command
+    // line buffer, so no command lines are received until it is done).
+    //
+    if (work.pending)
+    {
+        return (ResumeCmd()) ? 1 : processed;
+    }
+
+    if (lineQueue == NULL)
     {
         //
-        // Get any available text from the user.
+        // Get any available text from the user, a command line at a time.
         //
-        for (uint8_t i = input.index; i < (sizeof(input.g_cCmdBuf) - 1); ++i)
+        if (!work.lineReady)
         {
-            if (serial.available())
+            if (!RxLine(&maxChars, &ch))
             {
-                ch = (serial.read() & 0x7f);
-                if (input.echoEnable)
-                {
-                    if (((ch != '\r') && (ch != '\n')) || input.crLfechoEnable)
-                    {
-                        serial.write(ch);       // echo received character
-                    }
-                }
-                if ((ch == terminators[0]) || (ch == terminators[1]))
-                {
-                    if ((ch != '\r') && (ch != '\n'))
-                    {
-                        input.g_cCmdBuf[input.index++] = ch;    // include termination character
-                    }
-                    // end-of-command
-                    break;
-                }
-                else if (ch == CHAR_BS)
-                {
-                    if (input.index)
-                    {
-                        --input.index;
-                    }
-                }
-                else if (ch == '\n')
-                {
-                    // ignore LF
-                }
-                else
-                {
-                    input.g_cCmdBuf[input.index++] = ch;
-                }
+                return processed;   // no command to process yet
             }
-            else
+            work.lineReady = true;
+            work.crLf = ((ch == '\r') || (ch == '\n'));
+            if (OutOfTime())
             {
-                return 0;       // no command to process yet
+                return processed;   // execute the command on the next call
             }
         }
-        input.g_cCmdBuf[input.index] = '\0';
+        if (work.showing)
+        {
+            return processed;       // execute the command after the listing
+        }
+        work.lineReady = false;
+        ExecLine(CmdBuf(), work.crLf);
+        NewLine();
+        return (work.showing || work.pending) ? 0 : 1;  // command processed (unless it started a listing
+                                                        // or is in progress)
+    }
 
-        if (strlen(input.g_cCmdBuf) > 0)
+    //
+    // Execute the queued command lines (left from the last call), then get all
+    // of the available text from the user (while there is room in the line queue
+    // for the command lines), then execute the queued command lines.
+    //
+    if (!ExecQueue(&processed))
+    {
+        return processed;
+    }
+    while (!lineQueue->Full() && RxLine(&maxChars, &ch))
+    {
+        lineQueue->Push(CmdBuf(), input.index, ((ch == '\r') || (ch == '\n')));
+        NewLine();
+        if (OutOfTime())
         {
-            if (((ch == '\r') || (ch == '\n')) && input.crLfcmdEnable)
-            {
-                serial.println();
-            }
-            //
-            // Pass the line from the user to the command processor.
-            // It will be parsed and valid commands executed.
-            //
-            nStatus = CmdLineProcess(input.g_cCmdBuf);
-            if (errorFunc != NULL)
-            {
-                errorFunc(nStatus);
-            }
-            else    // internal commands error handling
-            {
-                switch (nStatus)
-                {
-                    // Handle the case of bad command.
-                    case CMDLINE_BAD_CMD:
-                        serial.println(F("Bad command!"));
-                        break;
-
-                    // Handle the case of too many arguments.
-                    case CMDLINE_TOO_MANY_ARGS:
-                        serial.println(F("Too many arguments for command processor!"));
-                        break;
-
-                    // Handle the case of too few arguments.
-                    case CMDLINE_TOO_FEW_ARGS:
-                        serial.println(F("Not enough arguments for command processor!"));
-                        break;
-
-                    // Handle the case of invalid argument.
-                    case CMDLINE_INVALID_ARG:
-                        serial.println(F("Invalid argument for command processor!"));
-                        break;
-
-                    // Otherwise the command was executed.  Print the error
-                    // code if one was returned.
-                    default:
-                        if (nStatus != 0)
-                        {
-                            serial.print(F("Command returned error code: "));
-                            serial.println(nStatus);
-                        }
-                        break;
-                }
-            }
+            return processed;
         }
-        input.index = 0;
-        return 1;       // command processed
     }
+    ExecQueue(&processed);
+    return processed;
 }
 
 /*
  * NAME:
- *  int8_t CmdLineProcess(char * pcCmdLine)
+ *  size_t Feed(const uint8_t * data, size_t len)
  *
  * PARAMETERS:
- *  char * pcCmdLine = string that contains a command line
+ *  const uint8_t * data = the received characters
+ *  size_t len = the number of characters
  *
  * WHAT:
- *  Processes a command line string into arguments and executes the command.
- *
- *  This function takes the supplied command line string and breaks it up
- *  into individual arguments.  The first argument is treated as a command and
- *  is searched for in the command table.  If the command is found, then the
- *  command function is called and all of the command line arguments are passed
- *  in the normal argc, argv form.
+ *  Processes a chunk of received characters handed over by the caller (the
+ *  push counterpart of polling the stream with DoCmdLine()).
  *
- *  The command table is contained in a menu array named "g_sCmdTable" which
- *  must be provided by the application.
+ *  The characters go through the same command line (or frame) assembly and
+ *  echo as in DoCmdLine(), and each complete command line is
+ *  executed.
  *
  * RETURN VALUES:
- *  int8_t = CMDLINE_BAD_CMD if the command is not found,
- *         = CMDLINE_TOO_MANY_ARGS if there are more arguments than can be parsed.
- *           Otherwise it returns the code that was returned by the command function.
+ *  size_t = the number of characters taken (less than 'len' if a command
+ *           or a command listing is in progress - the command line buffer is
+ *           in use until DoCmdLine() has finished it)
  *
  * SPECIAL CONSIDERATIONS:
- *  If the command is not found in the menu array and a default handler has been
- *  set up (see SetDefaultHandler()), the default handler will be called to handle
- *  the unknown command.
+ *  The characters are staged in the chunk of received characters (so they go
+ *  through the same echo as the stream's), a CMDLINE_RX_CHUNK at a time. Those
+ *  left in the chunk when a command or listing starts are processed after it
+ *  (as with the stream), and the rest of 'data' is only looked at for the break
+ *  character (see Cancel()). The line queue is not used, and there is no time
+ *  budget.
  */
-int8_t CommandLine::CmdLineProcess(char * pcCmdLine)
+size_t CommandLineBase::Feed(const uint8_t * data, size_t len)
 {
-    char * pcChar;
-    int8_t argc;
-    uint8_t bFindArg = 1;
-    pfnCmdLine menuFunc;
-    tCmdLineEntry * pCmdEntry;
-#ifdef ESP8266
-    PGM_P * pgmp;
-    pfnCmdLine * pfn;
-#endif
+    size_t pos = 0;
+    size_t brk;
+    char ch;
 
-    //
-    // Initialize the argument counter, and point to the beginning of the
-    // command line string.
-    //
-    argc = 0;
-    pcChar = pcCmdLine;
+    work.timed = false;
 
-    //
-    // Advance through the command line until a zero character (end of command line) is found.
-    //
-    while (*pcChar)
+    // a command error or a command line left by DoCmdLine() goes first
+    if (work.statusPending)
     {
-        //
-        // If there is the delimiter, then replace it with a zero, and set the flag
-        // to search for the next argument.
-        //
-        if (*pcChar == delimiter)
-        {
-            *pcChar = '\0';
-            bFindArg = 1;
-        }
-        //
-        // Otherwise it is not a delimiter, so it must be a character that is part
-        // of an argument.
-        //
-        else
+        work.statusPending = false;
+        ReportStatus(work.status);
+    }
+    if (work.lineReady && !work.showing && !work.pending)
+    {
+        work.lineReady = false;
+        ExecLine(CmdBuf(), work.crLf);
+        NewLine();
+    }
+
+    for ( ; ; )
+    {
+        if (work.pending || work.showing)
         {
             //
-            // If bFindArg is set, then that means we are looking for the start
-            // of the next argument.
+            // The command line buffer is in use, so only look for the break character
+            // (in the chunk, then in the rest of the characters).
             //
-            if (bFindArg)
+            if ((frame.mode != CMDLINE_FRAME_TEXT) || (input.breakChar == CMDLINE_NO_BREAK))
             {
-                //
-                // As long as the maximum number of arguments has not been
-                // reached, then save the pointer to the start of this new arg
-                // in the argv array, and increment the count of args, argc.
-                //
-                if (argc < CMDLINE_MAX_ARGS)
+                break;
+            }
+            if (!RxBreak())
+            {
+                for (brk = pos; (brk < len) && ((data[brk] & 0x7f) != input.breakChar); ++brk)
                 {
-                    argv[argc] = pcChar;
-                    argc++;
-                    bFindArg = 0;
                 }
-                //
-                // The maximum number of arguments has been reached so return
-                // the error.
-                //
-                else
+                if (brk >= len)
                 {
-                    return CMDLINE_TOO_MANY_ARGS;
+                    break;
                 }
+                pos = brk + 1;
+                rx.pos = rx.len;    // the type-ahead is dropped (not echoed)
+                rx.echo = rx.pos;
+                CMDLINE_COUNT(bytesIn);
             }
+            Cancel();
         }
+        else
+        {
+            if (rx.pos >= rx.len)
+            {
+                if (pos >= len)
+                {
+                    break;
+                }
 
-        //
-        // Advance to the next character in the command line.
-        //
-        pcChar++;
+                // stage the next part of the characters in the chunk
+                EchoFlush();
+                rx.len = (uint8_t)(((len - pos) > sizeof(rx.buf)) ? sizeof(rx.buf) : (len - pos));
+                memcpy(rx.buf, &data[pos], rx.len);
+                pos += rx.len;
+                rx.pos = 0;
+                rx.echo = 0;
+            }
+            CMDLINE_COUNT(bytesIn);
+            if (RxByte(&ch))
+            {
+                ExecLine(CmdBuf(), ((ch == '\r') || (ch == '\n')));
+                NewLine();
+            }
+        }
     }
+    EchoFlush();
+    return pos;
+}
 
-    //
-    // If one or more arguments was found, then process the command.
-    //
-    if (argc)
+/*
+ * NAME:
+ *  bool ExecQueue(int8_t * processed)
+ *
+ * PARAMETERS:
+ *  int8_t * processed = place to set to 1 if a command was processed
+ *
+ * WHAT:
+ *  Executes the queued command lines (while there is time left in the budget,
+ *  and no command listing or command is in progress).
+ *
+ * RETURN VALUES:
+ *  bool = true = the line queue is empty
+ *         false = out of time (command lines or a command error report are left)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line of a command in progress is kept in the queue until the
+ *  command is done (see ResumeCmd()).
+ */
+bool CommandLineBase::ExecQueue(int8_t * processed)
+{
+    char * pcLine;
+    bool crLf;
+
+    while (!work.showing && ((pcLine = lineQueue->Front(&crLf)) != NULL))
+    {
+        ExecLine(pcLine, crLf);
+        if (work.pending)
+        {
+            pending.queued = true;
+            return false;       // the command is in progress
+        }
+        if (!work.showing)
+        {
+            *processed = 1;     // command processed (unless it started a listing)
+        }
+        lineQueue->Pop();
+        if (work.statusPending || OutOfTime())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * NAME:
+ *  bool RxByte(char * last)
+ *
+ * PARAMETERS:
+ *  char * last = place for the received character (if it ended the command line)
+ *
+ * WHAT:
+ *  Adds the next received byte of the chunk to the command line (or the frame,
+ *  in the binary, SLIP or COBS framing modes).
+ *
+ * RETURN VALUES:
+ *  bool = true = the command line is complete (in the command line buffer)
+ *         false = the command line is not complete yet
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Any echo of the received characters is written when the command line is
+ *  complete. (Used by RxLine() and Feed(), so it is inline.)
+ */
+inline bool CommandLineBase::RxByte(char * last)
+{
+    char ch;
+    bool done;
+
+    switch (frame.mode)
+    {
+        case CMDLINE_FRAME_BINARY:
+            ch = '\0';
+            done = RxFrame(rx.buf[rx.pos++]);
+            break;
+        case CMDLINE_FRAME_SLIP:
+            ch = '\0';
+            done = RxSlip(rx.buf[rx.pos++]);
+            break;
+        case CMDLINE_FRAME_COBS:
+            ch = '\0';
+            done = RxCobs(rx.buf[rx.pos++]);
+            break;
+        default:    // CMDLINE_FRAME_TEXT
+            ch = (char)(rx.buf[rx.pos] &= 0x7f);     // (stripped in place for the echo)
+            if ((((ch == '\r') || (ch == '\n')) && !input.crLfechoEnable) ||
+                ((ch == input.breakChar) && (ch != CMDLINE_NO_BREAK)))
+            {
+                EchoFlush();    // CR/LF (or the break character) is not echoed
+                rx.echo = rx.pos + 1;
+            }
+            ++rx.pos;
+            done = RxChar(ch);
+            break;
+    }
+    if (done)
+    {
+        EchoFlush();
+#if CMDLINE_COUNTERS
+        if (input.index > counters.maxLineLen)
+        {
+            counters.maxLineLen = input.index;
+        }
+#endif
+        CmdBuf()[input.index] = '\0';
+        *last = ch;
+    }
+    return done;
+}
+
+/*
+ * NAME:
+ *  bool RxLine(uint16_t * maxChars, char * last)
+ *
+ * PARAMETERS:
+ *  uint16_t * maxChars = the maximum number of received characters to process
+ *                        (updated with the number remaining)
+ *  char * last = place for the last received character (the one that ended the command line)
+ *
+ * WHAT:
+ *  Gets available text from the user until a command line (or a frame, in
+ *  the binary, SLIP or COBS framing modes) is complete.
+ *
+ *  Stops before pulling in another chunk of received characters if the
+ *  time budget for the DoCmdLine() call has run out.
+ *
+ * RETURN VALUES:
+ *  bool = true = a command line is complete (in the command line buffer)
+ *         false = no command line yet (out of received characters)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Any echo of the received characters is written before returning (the echo
+ *  is written from the receive chunk, a write per chunk or command line).
+ */
+bool CommandLineBase::RxLine(uint16_t * maxChars, char * last)
+{
+    uint8_t rxChunks = 0;
+
+    while (*maxChars)
     {
         //
-        // Start at the beginning of the command table, to look for a matching
-        // command.
+        // Pull in the next chunk of received characters (if the last chunk has
+        // all been used).
         //
-        pCmdEntry = (tCmdLineEntry *)&g_sCmdTable[0];
+        if (rx.pos >= rx.len)
+        {
+            if ((rxChunks++ && OutOfTime()) || !RxFill())
+            {
+                break;
+            }
+        }
 
         //
-        // Search through the command table until a null command string is
-        // found, which marks the end of the table.
+        // Scan the chunk for the end of the command (any characters after it are
+        // kept for the next command).
         //
-        while (1)
+        while ((rx.pos < rx.len) && *maxChars)
         {
-#ifdef ESP8266
-            pgmp = &(pCmdEntry->pcCmd);    // prevents dereferencing type-punned pointer warning
-            if (pgm_read_dword(pgmp) == 0)
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-            if (pCmdEntry->pcCmd == 0)
-#else
-            if (pgm_read_word(&pCmdEntry->pcCmd) == 0)
-#endif
+            --*maxChars;
+            CMDLINE_COUNT(bytesIn);
+            if (RxByte(last))
             {
-                break;
+                return true;
             }
-            //
-            // If this command entry command string matches argv[0], then call
-            // the function for this command, passing the command line
-            // arguments.
-            //
-#ifdef ESP8266
-            if (!strcasecmp_P(argv[0], (PGM_P)pgm_read_dword(pgmp)))
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-            if (!strcasecmp(argv[0], pCmdEntry->pcCmd))
+        }
+    }
+    EchoFlush();
+    return false;
+}
+
+/*
+ * NAME:
+ *  bool RxFill(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Pulls in the next chunk of received characters (the characters available
+ *  from the stream, or the receive ring, up to CMDLINE_RX_CHUNK).
+ *
+ * RETURN VALUES:
+ *  bool = true = a chunk of characters was received
+ *         false = no characters available
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Any characters left in the last chunk are dropped (the echo of the last
+ *  chunk is written first).
+ */
+bool CommandLineBase::RxFill(void)
+{
+    EchoFlush();
+    rx.len = RxRead(rx.buf, sizeof(rx.buf));
+    rx.pos = 0;
+    rx.echo = 0;
+    return (rx.len != 0);
+}
+
+/*
+ * NAME:
+ *  uint8_t RxRead(uint8_t * buf, uint8_t size)
+ *
+ * PARAMETERS:
+ *  uint8_t * buf = place for the received characters
+ *  uint8_t size = the size of 'buf'
+ *
+ * WHAT:
+ *  Reads the available received characters from the stream (up to 'size').
+ *
+ * RETURN VALUES:
+ *  uint8_t = the number of characters read (0 = none available)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+uint8_t CommandLineBase::RxRead(uint8_t * buf, uint8_t size)
+{
+    int avail;
+    uint8_t len;
+
+    if (input.fromRing)
+    {
+        // the received characters are fed to the ring by an interrupt handler
+        len = (uint8_t)source.rxRing->Get(buf, size);
+    }
+    else
+    {
+        avail = (source.serial != NULL) ? source.serial->available() : 0;
+        if (avail <= 0)
+        {
+            return 0;
+        }
+        if (avail > (int)size)
+        {
+            avail = size;
+        }
+#if defined(ESP8266) || defined(ESP32)
+        // these cores have a (virtual) buffered readBytes()
+        len = (uint8_t)source.serial->readBytes(buf, avail);
 #else
-            if (!strcasecmp_P(argv[0], (PGM_P)pgm_read_word(&pCmdEntry->pcCmd)))
+        // readBytes() is a timed read() per character on the other cores
+        for (len = 0; len < avail; ++len)
+        {
+            buf[len] = (uint8_t)source.serial->read();
+        }
 #endif
+    }
+    return len;
+}
+
+/*
+ * NAME:
+ *  bool RxBreak(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Checks the received characters for the break character (while a command
+ *  or a command listing is in progress, and received characters are not
+ *  processed).
+ *
+ *  All of the available received characters are looked at. They are kept in
+ *  the chunk of received characters (up to CMDLINE_RX_CHUNK of them), to be
+ *  processed (and echoed) after the work in progress. The break character is
+ *  taken out of the chunk along with the characters before it.
+ *
+ * RETURN VALUES:
+ *  bool = true = the break character was received
+ *         false = no break character
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Once the chunk is full, the characters received after it are looked at
+ *  and dropped (there is no room to keep them), up to the break character.
+ */
+bool CommandLineBase::RxBreak(void)
+{
+    uint8_t drop[CMDLINE_RX_CHUNK];
+    uint8_t pos;
+    uint8_t len;
+
+    if (input.breakChar == CMDLINE_NO_BREAK)
+    {
+        return false;
+    }
+
+    // move the characters not processed yet to the start of the chunk (to make room)
+    if (rx.pos > 0)
+    {
+        EchoFlush();
+        rx.len -= rx.pos;
+        memmove(rx.buf, &rx.buf[rx.pos], rx.len);
+        rx.pos = 0;
+        rx.echo = 0;
+    }
+
+    for (pos = 0; ; )
+    {
+        for ( ; pos < rx.len; ++pos)
+        {
+            if ((rx.buf[pos] & 0x7f) == input.breakChar)
             {
-#ifdef ESP8266
-                pfn = &(pCmdEntry->pfnCmd);    // prevents dereferencing type-punned pointer warning
-                menuFunc = (pfnCmdLine)pgm_read_dword(pfn);
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-                menuFunc = pCmdEntry->pfnCmd;
-#else
-                menuFunc = (pfnCmdLine)pgm_read_word(&pCmdEntry->pfnCmd);
-#endif
-                return menuFunc(argc, argv);
+                rx.pos = pos + 1;
+                rx.echo = rx.pos;   // the type-ahead is dropped (not echoed)
+                CMDLINE_COUNT(bytesIn);
+                return true;
+            }
+        }
+        if (rx.len < sizeof(rx.buf))
+        {
+            // keep the characters in the chunk
+            len = RxRead(&rx.buf[rx.len], sizeof(rx.buf) - rx.len);
+            if (len == 0)
+            {
+                return false;
+            }
+            rx.len += len;
+        }
+        else
+        {
+            // the chunk is full, so the characters are only looked at
+            len = RxRead(drop, sizeof(drop));
+            if (len == 0)
+            {
+                return false;
+            }
+            for (pos = 0; pos < len; ++pos)
+            {
+                if ((drop[pos] & 0x7f) == input.breakChar)
+                {
+                    // keep the characters after it
+                    rx.len = len - (pos + 1);
+                    memcpy(rx.buf, &drop[pos + 1], rx.len);
+                    rx.pos = 0;
+                    rx.echo = 0;
+                    CMDLINE_COUNT(bytesIn);
+                    return true;
+                }
             }
+            pos = rx.len;
+        }
+    }
+}
 
-            //
-            // Not found, so advance to the next entry.
-            //
-            pCmdEntry++;
+/*
+ * NAME:
+ *  void Cancel(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Cancels the work in progress (the break character was received):
+ *   - discards the output waiting to be written (in the output queue)
+ *   - stops a command listing
+ *   - aborts a command in progress (it is called once more, with CmdAborted()
+ *     set, to clean up)
+ *   - discards the command line being received (and any queued command lines)
+ *
+ *  CMDLINE_ABORTED is reported if a command or listing was stopped (otherwise
+ *  "^C" is echoed, if echo is enabled).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::Cancel(void)
+{
+    bool active = (work.pending || work.showing);
+
+    if (input.outQueued)
+    {
+        static_cast<CmdLineOutput *>(output)->Clear();
+    }
+
+    work.showing = false;
+    if (work.pending)
+    {
+        work.aborted = true;
+        RecallCmd();
+        work.aborted = false;
+        work.pending = false;
+        argsValid = false;
+    }
+
+    if (lineQueue != NULL)
+    {
+        lineQueue->Clear();
+    }
+    work.lineReady = false;
+    FlushReceive();
+
+    if (active)
+    {
+        ReportStatus(CMDLINE_ABORTED);
+    }
+    else if (input.echoEnable)
+    {
+        output->println(F("^C"));
+    }
+}
+
+/*
+ * NAME:
+ *  void ExecLine(char * pcLine, bool crLf)
+ *
+ * PARAMETERS:
+ *  char * pcLine = the command line
+ *  bool crLf = a flag that the command line was ended by a CR or LF character
+ *
+ * WHAT:
+ *  Executes a command line (or a binary frame, in the binary framing mode)
+ *  and reports any command error. (The command line of a SLIP or COBS frame
+ *  is executed as a received text command line.)
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  If the time budget has run out when the command returns, its error report
+ *  is left for the next DoCmdLine() call. A command that returns CMDLINE_PENDING
+ *  is left in progress (see ResumeCmd()).
+ */
+void CommandLineBase::ExecLine(char * pcLine, bool crLf)
+{
+    int8_t nStatus;
+
+    pending.rest = 0;       // (no rest of a batch, unless set by ExecBatch())
+    if (frame.mode == CMDLINE_FRAME_BINARY)
+    {
+        nStatus = ExecFrame((uint8_t *)pcLine);
+    }
+    else if (((pcLine == CmdBuf()) && (rxArgs != CMDLINE_RX_UNSPLIT)) ? (input.index > 0) : (strlen(pcLine) > 0))
+    {
+        frame.reply = false;
+        if (crLf && input.crLfcmdEnable)
+        {
+            output->println();
+        }
+        //
+        // Pass the line from the user to the command processor.
+        // It will be parsed and valid commands executed.
+        //
+        if (batch.separator != CMDLINE_NO_BATCH)
+        {
+            nStatus = ExecBatch(pcLine, 0, false, 0);
+        }
+        else
+        {
+            nStatus = CmdLineProcess(pcLine);
         }
     }
+    else
+    {
+        return;
+    }
+    CMDLINE_COUNT(lines);
+    if (nStatus == CMDLINE_PENDING)
+    {
+        work.pending = true;
+        pending.queued = false;
+        return;
+    }
+    EndLine(nStatus);
+}
+
+/*
+ * NAME:
+ *  void EndLine(int8_t nStatus)
+ *
+ * PARAMETERS:
+ *  int8_t nStatus = the status of the executed command line
+ *
+ * WHAT:
+ *  Reports a command error (or answers a binary frame) when a command line
+ *  is done.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  If the time budget has run out, the report is left for the next DoCmdLine() call.
+ */
+void CommandLineBase::EndLine(int8_t nStatus)
+{
+    if (OutOfTime())
+    {
+        work.status = nStatus;
+        work.statusPending = true;
+        return;
+    }
+    ReportStatus(nStatus);
+}
+
+/*
+ * NAME:
+ *  bool ResumeCmd(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Calls the command in progress (that returned CMDLINE_PENDING) again, or
+ *  aborts it if the break character was received (in the text console).
+ *
+ *  When the command is done, the rest of its command batch is executed, and
+ *  its command line is released (taken off the line queue, if one is set).
+ *
+ * RETURN VALUES:
+ *  bool = true = the command is done (or aborted)
+ *         false = the command is still in progress
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  An aborted command is called once more to clean up (see Cancel()), and the
+ *  rest of its batch is skipped.
+ */
+bool CommandLineBase::ResumeCmd(void)
+{
+    int8_t nStatus;
+    char * pcLine;
+    bool crLf;
+
+    if ((frame.mode == CMDLINE_FRAME_TEXT) && RxBreak())
+    {
+        Cancel();
+        return true;
+    }
+
+    nStatus = RecallCmd();
+    if (nStatus == CMDLINE_PENDING)
+    {
+        return false;
+    }
+    argsValid = false;
+    if ((pending.rest != 0) && ((nStatus == 0) || !batch.stopOnError))
+    {
+        // the command line is still in the line queue (or the command line buffer)
+        pcLine = (pending.queued) ? lineQueue->Front(&crLf) : CmdBuf();
+        nStatus = ExecBatch(pcLine, pending.rest, true, nStatus);
+        if (nStatus == CMDLINE_PENDING)
+        {
+            return false;
+        }
+    }
+
+    work.pending = false;
+    argsValid = false;
+    if (pending.queued)
+    {
+        lineQueue->Pop();
+    }
+    EndLine(nStatus);
+    return true;
+}
+
+/*
+ * NAME:
+ *  int8_t RecallCmd(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Calls the command in progress (that returned CMDLINE_PENDING) again.
+ *
+ * RETURN VALUES:
+ *  int8_t = the code that was returned by the command function
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Its argument values (see ArgValue()) are still in the command line buffers.
+ */
+int8_t CommandLineBase::RecallCmd(void)
+{
+    return RunCmd((pending.entry == PENDING_DEFAULT) ? NULL : &cmdTable[pending.entry], pending.argc);
+}
+
+/*
+ * NAME:
+ *  int8_t ExecBatch(char * pcLine, uint16_t start, bool executed, int8_t nStatus)
+ *
+ * PARAMETERS:
+ *  char * pcLine = the command line (a batch of commands split by the batch separator)
+ *  uint16_t start = the offset in the command line of the commands to execute (the batch
+ *                   is resumed after a command in progress)
+ *  bool executed = a flag that a command of the batch was executed (the batch is
+ *                  resumed after a command in progress)
+ *  int8_t nStatus = the status of that command
+ *
+ * WHAT:
+ *  Executes the commands of a command batch in order ("cmd1 a; cmd2 b; cmd3").
+ *
+ *  The status of each command but the last one executed is reported here; the
+ *  caller reports the last one. If stop-on-error is set, the rest of the batch
+ *  is skipped after a command returns an error.
+ *
+ * RETURN VALUES:
+ *  int8_t = the status of the last command executed
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Empty commands in the batch are skipped (a batch with no commands is
+ *  processed as an empty command line).
+ *
+ *  If a command returns CMDLINE_PENDING, the offset of the rest of the batch
+ *  is kept (in pending.rest) for when the command is done (see ResumeCmd()).
+ */
+int8_t CommandLineBase::ExecBatch(char * pcLine, uint16_t start, bool executed, int8_t nStatus)
+{
+    char * pcCmd = &pcLine[start];
+    char * pcNext;
+    char * pcChar;
+
+    pending.rest = 0;
+    while (pcCmd != NULL)
+    {
+        //
+        // Split off the next command of the batch.
+        //
+        pcNext = strchr(pcCmd, batch.separator);
+        if (pcNext != NULL)
+        {
+            *pcNext++ = '\0';
+        }
+
+        // skip empty commands
+        for (pcChar = pcCmd; (*pcChar == delimiter); ++pcChar)
+        {
+        }
+        if (*pcChar != '\0')
+        {
+            if (executed)
+            {
+                ReportStatus(nStatus);  // status of the previous command
+            }
+            nStatus = CmdLineProcess(pcCmd);
+            executed = true;
+            if (nStatus == CMDLINE_PENDING)
+            {
+                if (pcNext != NULL)
+                {
+                    pending.rest = (uint16_t)(pcNext - pcLine);
+                }
+                break;
+            }
+            if ((nStatus != 0) && batch.stopOnError)
+            {
+                break;
+            }
+        }
+        pcCmd = pcNext;
+    }
+
+    if (!executed)
+    {
+        nStatus = CmdLineProcess(pcLine);
+    }
+    return nStatus;
+}
+
+/*
+ * NAME:
+ *  void ReportStatus(int8_t nStatus)
+ *
+ * PARAMETERS:
+ *  int8_t nStatus = the command status (returned by the command function)
+ *
+ * WHAT:
+ *  Reports a command error (to the custom error handler, or internally), or
+ *  answers a binary frame with a status frame.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ReportStatus(int8_t nStatus)
+{
+    if (nStatus == CMDLINE_BAD_CMD)
+    {
+        CMDLINE_COUNT(badCmds);
+    }
+    if (frame.reply)
+    {
+        SendFrame(frame.id, nStatus);
+        if (frame.id == CMDLINE_FRAME_EXIT)
+        {
+            FrameMode(CMDLINE_FRAME_TEXT);
+        }
+    }
+    else if (errorFunc != NULL)
+    {
+        errorFunc(nStatus);
+    }
+    else    // internal commands error handling
+    {
+        switch (nStatus)
+        {
+            // Handle the case of bad command.
+            case CMDLINE_BAD_CMD:
+                output->println(F("Bad command!"));
+                break;
+
+            // Handle the case of too many arguments.
+            case CMDLINE_TOO_MANY_ARGS:
+                output->println(F("Too many arguments for command processor!"));
+                break;
+
+            // Handle the case of too few arguments.
+            case CMDLINE_TOO_FEW_ARGS:
+                output->println(F("Not enough arguments for command processor!"));
+                break;
+
+            // Handle the case of invalid argument.
+            case CMDLINE_INVALID_ARG:
+                output->println(F("Invalid argument for command processor!"));
+                break;
+
+            // Handle the case of an aborted command.
+            case CMDLINE_ABORTED:
+                output->println(F("Command aborted!"));
+                break;
+
+            // Otherwise the command was executed.  Print the error
+            // code if one was returned.
+            default:
+                if (nStatus != 0)
+                {
+                    output->print(F("Command returned error code: "));
+                    output->println(nStatus);
+                }
+                break;
+        }
+    }
+}
+
+/*
+ * NAME:
+ *  char RxArg(char ch)
+ *
+ * PARAMETERS:
+ *  char ch = a received character (being added at the end of the command line)
+ *
+ * WHAT:
+ *  Splits the command line into arguments as it is received (the work of
+ *  CmdLineProcess() when the command line is complete): the delimiter is
+ *  replaced with a zero, and the start of each argument is put in argv[].
+ *
+ * RETURN VALUES:
+ *  char = the character to put in the command line buffer
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Only done for command lines that are executed straight from the command
+ *  line buffer (see NewLine()). A received zero (which ends the command line
+ *  for CmdLineProcess()) or an argument past argv[] stops the split (see
+ *  RxArgsOff()), so the command line is scanned when it is complete.
+ */
+inline char CommandLineBase::RxArg(char ch)
+{
+    if (rxArgs == CMDLINE_RX_UNSPLIT)
+    {
+        return ch;
+    }
+    if (ch == delimiter)
+    {
+        return '\0';
+    }
+    if ((input.index == 0) || (CmdBuf()[input.index - 1] == '\0'))
+    {
+        // the start of an argument
+        if ((ch == '\0') || (rxArgs >= maxArgs))
+        {
+            RxArgsOff();
+            return ch;
+        }
+        argv[rxArgs++] = &CmdBuf()[input.index];
+    }
+    else if (ch == '\0')
+    {
+        RxArgsOff();
+    }
+    return ch;
+}
+
+/*
+ * NAME:
+ *  void RxUnarg(char ch)
+ *
+ * PARAMETERS:
+ *  char ch = the character removed from the end of the command line (by a backspace)
+ *
+ * WHAT:
+ *  Removes a character from the arguments in argv[] (undoes RxArg()).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  While the command line is split as it is received, a zero in the command
+ *  line buffer is a delimiter.
+ */
+inline void CommandLineBase::RxUnarg(char ch)
+{
+    if ((rxArgs != CMDLINE_RX_UNSPLIT) && (ch != '\0') &&
+        ((input.index == 0) || (CmdBuf()[input.index - 1] == '\0')))
+    {
+        --rxArgs;       // the first character of the last argument
+    }
+}
+
+/*
+ * NAME:
+ *  void RxArgsOff(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Stops splitting the command line being received into arguments (the
+ *  delimiters are put back), so it is scanned by CmdLineProcess() when it is
+ *  complete.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Used when a received zero, too many arguments or a change of the settings
+ *  (see Delimiter(), BatchSeparator() and SetLineQueue()) would make the split
+ *  differ from the scan.
+ */
+void CommandLineBase::RxArgsOff(void)
+{
+    char * pcLine = CmdBuf();
+
+    if (rxArgs == CMDLINE_RX_UNSPLIT)
+    {
+        return;
+    }
+    for (uint16_t pos = 0; pos < input.index; ++pos)
+    {
+        if (pcLine[pos] == '\0')
+        {
+            pcLine[pos] = delimiter;
+        }
+    }
+    rxArgs = CMDLINE_RX_UNSPLIT;
+}
+
+/*
+ * NAME:
+ *  bool RxChar(char ch)
+ *
+ * PARAMETERS:
+ *  char ch = a received character
+ *
+ * WHAT:
+ *  Adds a received character to the command line (with backspace and break
+ *  character handling).
+ *
+ * RETURN VALUES:
+ *  bool = true = the command line is complete (a terminator was received or
+ *                the command line buffer is full)
+ *         false = the command line is not complete yet
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+bool CommandLineBase::RxChar(char ch)
+{
+    if ((ch == input.breakChar) && (ch != CMDLINE_NO_BREAK))
+    {
+        Cancel();
+        return false;
+    }
+    if (IsTerminator(ch))
+    {
+        if ((ch != '\r') && (ch != '\n'))
+        {
+            RxName(ch);
+            ch = RxArg(ch);
+            CmdBuf()[input.index++] = ch;    // include termination character
+        }
+        // end-of-command
+        return true;
+    }
+    else if (ch == CHAR_BS)
+    {
+        CMDLINE_COUNT(backspaces);
+        if (input.index)
+        {
+            --input.index;
+            if (hashIndex != NULL)
+            {
+                hashIndex->NameRemove(input.index, CmdBuf()[input.index]);
+            }
+            RxUnarg(CmdBuf()[input.index]);
+        }
+    }
+    else if (ch == '\n')
+    {
+        // ignore LF
+    }
+    else
+    {
+        RxName(ch);
+        ch = RxArg(ch);
+        CmdBuf()[input.index++] = ch;
+    }
+
+    // a full command line buffer also ends the command
+    if (input.index >= (input.bufSize - 1))
+    {
+        CMDLINE_COUNT(overflows);
+        return true;
+    }
+    return false;
+}
+
+/*
+ * NAME:
+ *  void FrameMode(uint8_t mode)
+ *
+ * PARAMETERS:
+ *  uint8_t mode = the framing mode (CMDLINE_FRAME_TEXT, CMDLINE_FRAME_BINARY,
+ *                 CMDLINE_FRAME_SLIP or CMDLINE_FRAME_COBS)
+ *
+ * WHAT:
+ *  Sets the framing mode of the command line.
+ *
+ *  In the binary framing mode, commands are received as length-prefixed binary
+ *  frames and dispatched into the same command table functions, without echo
+ *  or text error messages. Each frame is answered with a status frame.
+ *
+ *  In the SLIP and COBS framing modes, each frame carries an 8-bit clean
+ *  command line (processed as a received text command line, without echo).
+ *  The command line can have any byte but 0x00 (a frame with a 0x00 in its
+ *  command line is dropped).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Any partly received command line or frame is discarded.
+ */
+void CommandLineBase::FrameMode(uint8_t mode)
+{
+    frame.mode = mode;
+    frame.state = (mode == CMDLINE_FRAME_BINARY) ? FRAME_SYNC : FRAME_DATA;
+    frame.code = 0;
+    frame.left = 0;
+    NewLine();
+}
+
+/*
+ * NAME:
+ *  bool RxFrame(uint8_t ch)
+ *
+ * PARAMETERS:
+ *  uint8_t ch = the received byte
+ *
+ * WHAT:
+ *  Adds a received byte to the binary frame (SYNC, LEN, command id, args..., CRC-8).
+ *
+ *  The frame is kept in the command line buffer as LEN, command id, args...
+ *  (a frame with a CRC error is marked with a LEN of 0).
+ *
+ * RETURN VALUES:
+ *  bool = true = a frame is complete (in the command line buffer)
+ *         false = no frame yet
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A frame with a bad LEN is dropped (the receiver waits for the next SYNC).
+ */
+bool CommandLineBase::RxFrame(uint8_t ch)
+{
+    switch (frame.state)
+    {
+        case FRAME_SYNC:
+            if (ch == CMDLINE_FRAME_SYNC)
+            {
+                frame.state = FRAME_LEN;
+            }
+            break;
+
+        case FRAME_LEN:
+            if ((ch == 0) || (ch > FrameMaxLen()))
+            {
+                if (ch != 0)
+                {
+                    CMDLINE_COUNT(overflows);
+                }
+                frame.state = FRAME_SYNC;   // bad LEN, drop the frame
+                break;
+            }
+            CmdBuf()[0] = (char)ch;
+            input.index = 1;
+            frame.crc = CmdLineCrc8(0, ch);
+            frame.state = FRAME_DATA;
+            break;
+
+        case FRAME_DATA:
+            CmdBuf()[input.index++] = (char)ch;
+            frame.crc = CmdLineCrc8(frame.crc, ch);
+            if (input.index > (uint8_t)CmdBuf()[0])
+            {
+                frame.state = FRAME_CRC;
+            }
+            break;
+
+        default:    // FRAME_CRC
+            frame.state = FRAME_SYNC;
+            if (ch != frame.crc)
+            {
+                CmdBuf()[0] = 0;     // mark the CRC error
+            }
+            return true;
+    }
+    return false;
+}
+
+/*
+ * NAME:
+ *  bool RxSlip(uint8_t ch)
+ *
+ * PARAMETERS:
+ *  uint8_t ch = the received byte
+ *
+ * WHAT:
+ *  Adds a received byte to the SLIP frame (RFC 1055), decoding it into the
+ *  command line buffer.
+ *
+ * RETURN VALUES:
+ *  bool = true = a frame is complete (its command line is in the command line buffer)
+ *         false = no frame yet
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A bad frame (too long, a bad escape sequence, or a 0x00 byte) is dropped up to
+ *  the next END.
+ *  Empty frames (back-to-back ENDs) are ignored.
+ */
+bool CommandLineBase::RxSlip(uint8_t ch)
+{
+    if (ch == CMDLINE_SLIP_END)
+    {
+        if ((frame.state == FRAME_DATA) && (input.index > 0))
+        {
+            return true;
+        }
+        frame.state = FRAME_DATA;   // resynchronized
+        input.index = 0;
+        return false;
+    }
+
+    switch (frame.state)
+    {
+        case FRAME_DROP:
+            return false;
+
+        case FRAME_ESC:
+            frame.state = FRAME_DATA;
+            if (ch == CMDLINE_SLIP_ESC_END)
+            {
+                ch = CMDLINE_SLIP_END;
+            }
+            else if (ch == CMDLINE_SLIP_ESC_ESC)
+            {
+                ch = CMDLINE_SLIP_ESC;
+            }
+            else
+            {
+                frame.state = FRAME_DROP;   // bad escape sequence
+                return false;
+            }
+            break;
+
+        default:    // FRAME_DATA
+            if (ch == CMDLINE_SLIP_ESC)
+            {
+                frame.state = FRAME_ESC;
+                return false;
+            }
+            break;
+    }
+    RxFramedChar(ch);
+    return false;
+}
+
+/*
+ * NAME:
+ *  bool RxCobs(uint8_t ch)
+ *
+ * PARAMETERS:
+ *  uint8_t ch = the received byte
+ *
+ * WHAT:
+ *  Adds a received byte to the COBS (0x00 delimited) frame, decoding it into
+ *  the command line buffer.
+ *
+ * RETURN VALUES:
+ *  bool = true = a frame is complete (its command line is in the command line buffer)
+ *         false = no frame yet
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A bad frame (too long, ended inside a block, or with a 0x00 byte in the decoded
+ *  command line) is dropped up to the next 0x00.
+ *  Empty frames are ignored.
+ */
+bool CommandLineBase::RxCobs(uint8_t ch)
+{
+    if (ch == 0x00)
+    {
+        if ((frame.state == FRAME_DATA) && (frame.left == 0) && (input.index > 0))
+        {
+            frame.code = 0;
+            return true;
+        }
+        frame.state = FRAME_DATA;   // resynchronized
+        frame.code = 0;
+        frame.left = 0;
+        input.index = 0;
+        return false;
+    }
+    if (frame.state == FRAME_DROP)
+    {
+        return false;
+    }
+
+    if (frame.left == 0)
+    {
+        //
+        // A code byte: the end of a block shorter than 254 bytes stands for a 0x00.
+        //
+        if ((frame.code != 0) && (frame.code != 0xFF))
+        {
+            RxFramedChar(0x00);
+        }
+        frame.code = ch;
+        frame.left = ch - 1;
+        return false;
+    }
+    --frame.left;
+    RxFramedChar(ch);
+    return false;
+}
+
+/*
+ * NAME:
+ *  void RxFramedChar(uint8_t ch)
+ *
+ * PARAMETERS:
+ *  uint8_t ch = the decoded frame byte
+ *
+ * WHAT:
+ *  Adds a decoded SLIP or COBS frame byte to the command line.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A frame too long for the command line buffer is dropped. So is a frame
+ *  with a 0x00 byte in it (the command line is a string, which would be cut
+ *  short at the 0x00).
+ */
+void CommandLineBase::RxFramedChar(uint8_t ch)
+{
+    if (input.index >= (input.bufSize - 1))
+    {
+        CMDLINE_COUNT(overflows);
+        frame.state = FRAME_DROP;   // too long
+        input.index = 0;
+        return;
+    }
+    if (ch == 0x00)
+    {
+        frame.state = FRAME_DROP;   // not a command line
+        input.index = 0;
+        return;
+    }
+    CmdBuf()[input.index++] = (char)ch;
+}
+
+/*
+ * NAME:
+ *  int8_t ExecFrame(uint8_t * pFrame)
+ *
+ * PARAMETERS:
+ *  uint8_t * pFrame = the binary frame (LEN, command id, args...)
+ *
+ * WHAT:
+ *  Decodes a binary frame into arguments (in place) and executes the command.
+ *
+ *  Each argument (a length byte followed by its characters) is made a string
+ *  by overwriting the length byte of the next argument with its terminator.
+ *  The command name (argv[0]) is the command table string itself, except on
+ *  AVR and ESP8266 (where Flash strings can not be read in place) where it is
+ *  copied from the command table into the end of the command line buffer.
+ *
+ * RETURN VALUES:
+ *  int8_t = CMDLINE_BAD_FRAME if the frame has a CRC error or its args are bad
+ *           (or, on AVR and ESP8266, the command name does not fit after the frame),
+ *         = CMDLINE_BAD_CMD if the command id is not in the command table,
+ *         = CMDLINE_TOO_MANY_ARGS if there are more arguments than can be parsed.
+ *           Otherwise it returns the code that was returned by the command function.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line buffer is two bytes longer than the largest frame (for the
+ *  terminators of the last argument and the command name).
+ */
+int8_t CommandLineBase::ExecFrame(uint8_t * pFrame)
+{
+    uint16_t end = pFrame[0] + 1;   // one past the last frame byte
+    uint16_t pos = 2;
+    uint8_t len;
+    uint16_t next;
+    uint8_t nextLen;
+    int8_t argc = 1;
+#if CMDLINE_FRAME_NAME_COPY
+    char * pcName;
+#endif
+    PGM_P pcCmd;
+    uint16_t i;
+
+    frame.reply = true;
+    frame.id = pFrame[1];
+    if (pFrame[0] == 0)
+    {
+        return CMDLINE_BAD_FRAME;   // CRC error
+    }
+    if (frame.id == CMDLINE_FRAME_EXIT)
+    {
+        return 0;   // back to the text console (after the status frame)
+    }
+
+    //
+    // Find the command table entry of the command id.
+    //
+    pcCmd = 0;
+    if (cmdTable != NULL)
+    {
+        for (i = 0; (i <= frame.id) && (i < numCmds); ++i)
+        {
+            if ((pcCmd = EntryCmd(&cmdTable[i])) == 0)
+            {
+                break;      // end of table
+            }
+        }
+        if (i <= frame.id)
+        {
+            pcCmd = 0;
+        }
+    }
+    if (pcCmd == 0)
+    {
+        return CMDLINE_BAD_CMD;
+    }
+
+    //
+    // Decode the arguments in place.
+    //
+    len = (pos < end) ? pFrame[pos] : 0;
+    while (pos < end)
+    {
+        if (argc >= maxArgs)
+        {
+            return CMDLINE_TOO_MANY_ARGS;
+        }
+        if (pos + 1 + len > end)
+        {
+            return CMDLINE_BAD_FRAME;   // argument past the end of the frame
+        }
+        next = pos + 1 + len;
+        nextLen = (next < end) ? pFrame[next] : 0;
+        pFrame[next] = '\0';
+        argv[argc++] = (char *)&pFrame[pos + 1];
+        pos = next;
+        len = nextLen;
+    }
+
+#if CMDLINE_FRAME_NAME_COPY
+    //
+    // Copy the command name (argv[0]) into the rest of the buffer.
+    //
+    pcName = (char *)&pFrame[end + 1];
+    argv[0] = pcName;
+    for (i = end + 1; ; ++i)
+    {
+        if (i >= input.bufSize)
+        {
+            return CMDLINE_BAD_FRAME;   // the command name does not fit
+        }
+        if ((*pcName++ = (char)pgm_read_byte(pcCmd++)) == '\0')
+        {
+            break;
+        }
+    }
+#else
+    //
+    // The command name (argv[0]) is the command table string.
+    //
+    argv[0] = (char *)pcCmd;
+#endif
+
+    return CallCmd(&cmdTable[frame.id], argc);
+}
+
+/*
+ * NAME:
+ *  void SendFrame(uint8_t id, int8_t nStatus)
+ *
+ * PARAMETERS:
+ *  uint8_t id = the command id of the executed frame
+ *  int8_t nStatus = the command status
+ *
+ * WHAT:
+ *  Writes a binary status frame (SYNC, 2, command id, status, CRC-8).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::SendFrame(uint8_t id, int8_t nStatus)
+{
+    uint8_t out[5];
+
+    out[0] = CMDLINE_FRAME_SYNC;
+    out[1] = 2;
+    out[2] = id;
+    out[3] = (uint8_t)nStatus;
+    out[4] = CmdLineCrc8(CmdLineCrc8(CmdLineCrc8(0, out[1]), out[2]), out[3]);
+    output->write(out, sizeof(out));
+}
+
+/*
+ * NAME:
+ *  int8_t CmdLineProcess(char * pcCmdLine)
+ *
+ * PARAMETERS:
+ *  char * pcCmdLine = string that contains a command line
+ *
+ * WHAT:
+ *  Processes a command line string into arguments and executes the command.
+ *
+ *  This function takes the supplied command line string and breaks it up
+ *  into individual arguments.  The first argument is treated as a command and
+ *  is searched for in the command table.  If the command is found, then the
+ *  command function is called and all of the command line arguments are passed
+ *  in the normal argc, argv form.
+ *
+ *  The command table is contained in a menu array named "g_sCmdTable" which
+ *  is provided by the application (unless a command table is set for this
+ *  command line, see SetCommandTable()).
+ *
+ *  If the command has an argument schema, its arguments are checked and
+ *  converted (see CheckArgs()) before the command function is called.
+ *
+ * RETURN VALUES:
+ *  int8_t = CMDLINE_BAD_CMD if the command is not found,
+ *         = CMDLINE_TOO_MANY_ARGS if there are more arguments than can be parsed.
+ *         = CMDLINE_TOO_MANY_ARGS, CMDLINE_TOO_FEW_ARGS or CMDLINE_INVALID_ARG
+ *           if the arguments do not match the command's argument schema.
+ *           Otherwise it returns the code that was returned by the command function.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  If the command is not found in the menu array and a default handler has been
+ *  set up (see SetDefaultHandler()), the default handler will be called to handle
+ *  the unknown command.
+ *
+ *  The built-in commands (see BuiltinCmd()) are handled here if they are not
+ *  in the command table.
+ */
+int8_t CommandLineBase::CmdLineProcess(char * pcCmdLine)
+{
+    char * pcChar;
+    int8_t argc;
+    uint8_t bFindArg = 1;
+    const tCmdLineEntry * pCmdEntry;
+
+    //
+    // Initialize the argument counter, and point to the beginning of the
+    // command line string.
+    //
+    argc = 0;
+    pcChar = pcCmdLine;
+
+    //
+    // If the command line was split into arguments as it was received (see
+    // RxArg()), then they are already in argv[], so there is nothing to scan.
+    //
+    if ((pcCmdLine == CmdBuf()) && (rxArgs != CMDLINE_RX_UNSPLIT))
+    {
+        argc = (int8_t)rxArgs;
+        rxArgs = CMDLINE_RX_UNSPLIT;
+        pcChar = &pcCmdLine[input.index];       // the end of the command line
+    }
+
+    //
+    // Advance through the command line until a zero character (end of command line) is found.
+    //
+    while (*pcChar)
+    {
+        //
+        // If there is the delimiter, then replace it with a zero, and set the flag
+        // to search for the next argument.
+        //
+        if (*pcChar == delimiter)
+        {
+            *pcChar = '\0';
+            bFindArg = 1;
+        }
+        //
+        // Otherwise it is not a delimiter, so it must be a character that is part
+        // of an argument.
+        //
+        else
+        {
+            //
+            // If bFindArg is set, then that means we are looking for the start
+            // of the next argument.
+            //
+            if (bFindArg)
+            {
+                //
+                // As long as the maximum number of arguments has not been
+                // reached, then save the pointer to the start of this new arg
+                // in the argv array, and increment the count of args, argc.
+                //
+                if (argc < maxArgs)
+                {
+                    argv[argc] = pcChar;
+                    argc++;
+                    bFindArg = 0;
+                }
+                //
+                // The maximum number of arguments has been reached so return
+                // the error.
+                //
+                else
+                {
+                    return CMDLINE_TOO_MANY_ARGS;
+                }
+            }
+        }
+
+        //
+        // Advance to the next character in the command line.
+        //
+        pcChar++;
+    }
+
+    //
+    // If one or more arguments was found, then process the command.
+    //
+    if (argc)
+    {
+        //
+        // Look for a matching command in the command table. If found, then call
+        // the function for this command, passing the command line arguments.
+        //
+        pCmdEntry = FindCmd(argv[0]);
+        if (pCmdEntry != NULL)
+        {
+            return CallCmd(pCmdEntry, argc);
+        }
+
+#if CMDLINE_STATS || CMDLINE_COUNTERS
+        //
+        // Not in the command table, so check for the built-in commands.
+        //
+        if (BuiltinCmd(argc))
+        {
+            return 0;
+        }
+#endif
+    }
+
+    //
+    // Fall through to here means that no matching command was found, so return
+    // an error or call a configured default command handler.
+    //
+    if (defaultFunc == NULL)
+    {
+        return CMDLINE_BAD_CMD;
+    }
+    else
+    {
+        pending.state = 0;
+        return RunCmd(NULL, argc);
+    }
+}
+
+#if CMDLINE_STATS || CMDLINE_COUNTERS
+/*
+ * NAME:
+ *  bool BuiltinCmd(int8_t argc)
+ *
+ * PARAMETERS:
+ *  int8_t argc = number of command line arguments (in argv[])
+ *
+ * WHAT:
+ *  Executes a built-in command (one that is not in the command table):
+ *   - CMDLINE_STATS_CMD ["clear"] = shows (or clears) the command statistics
+ *     (if statistics are kept, see SetStats())
+ *   - CMDLINE_COUNTERS_CMD ["clear"] = shows (or clears) the receive path counters
+ *
+ * RETURN VALUES:
+ *  bool = true = a built-in command was executed
+ *         false = not a built-in command
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+bool CommandLineBase::BuiltinCmd(int8_t argc)
+{
+    bool clear = ((argc > 1) && !strcasecmp_P(argv[1], PSTR("clear")));
+
+#if CMDLINE_STATS
+    if ((stats != NULL) && !strcasecmp_P(argv[0], PSTR(CMDLINE_STATS_CMD)))
+    {
+        if (clear)
+        {
+            stats->Clear();
+        }
+        else
+        {
+            ShowStats();
+        }
+        return true;
+    }
+#endif
+#if CMDLINE_COUNTERS
+    if (!strcasecmp_P(argv[0], PSTR(CMDLINE_COUNTERS_CMD)))
+    {
+        if (clear)
+        {
+            ClearCounters();
+        }
+        else
+        {
+            ShowCounters();
+        }
+        return true;
+    }
+#endif
+    return false;
+}
+#endif
+
+/*
+ * NAME:
+ *  int8_t CallCmd(const tCmdLineEntry * pCmdEntry, int8_t argc)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * pCmdEntry = the command table entry of the command
+ *  int8_t argc = number of command line arguments (in argv[])
+ *
+ * WHAT:
+ *  Calls a command function with the parsed arguments.
+ *
+ *  If the command has an argument schema, its arguments are checked and
+ *  converted (see CheckArgs()) before the command function is called.
+ *
+ * RETURN VALUES:
+ *  int8_t = CMDLINE_TOO_MANY_ARGS, CMDLINE_TOO_FEW_ARGS or CMDLINE_INVALID_ARG
+ *           if the arguments do not match the command's argument schema.
+ *           Otherwise it returns the code that was returned by the command function.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command's state slot (see CmdState()) is cleared before the call.
+ */
+int8_t CommandLineBase::CallCmd(const tCmdLineEntry * pCmdEntry, int8_t argc)
+{
+    const tCmdLineArgs * pArgs;
+    int8_t nStatus;
+
+    pArgs = EntryArgs(pCmdEntry);
+    if (pArgs != NULL)
+    {
+        //
+        // The command has an argument schema, so check and convert all of
+        // its arguments before calling its function.
+        //
+        nStatus = CheckArgs(pArgs, argc);
+        if (nStatus != 0)
+        {
+            return nStatus;
+        }
+        argsValid = true;
+    }
+
+    pending.state = 0;
+    nStatus = RunCmd(pCmdEntry, argc);
+    if (nStatus != CMDLINE_PENDING)
+    {
+        argsValid = false;      // (the values stay valid while the command is in progress)
+    }
+    return nStatus;
+}
+
+/*
+ * NAME:
+ *  int8_t RunCmd(const tCmdLineEntry * pCmdEntry, int8_t argc)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * pCmdEntry = the command table entry of the command
+ *                                    (NULL = the default handler, see SetDefaultHandler())
+ *  int8_t argc = number of command line arguments (in argv[])
+ *
+ * WHAT:
+ *  Calls a command function (the first call, or a call of a command in progress).
+ *
+ *  If the command function returns CMDLINE_PENDING, the command is kept to be
+ *  called again (see ResumeCmd()).
+ *
+ * RETURN VALUES:
+ *  int8_t = the code that was returned by the command function
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  With command statistics (see SetStats()), the command function call is timed
+ *  (each call of a command in progress is counted as a call).
+ */
+int8_t CommandLineBase::RunCmd(const tCmdLineEntry * pCmdEntry, int8_t argc)
+{
+    int8_t nStatus;
+#if CMDLINE_STATS
+    uint32_t start;
+#endif
+
+    if (pCmdEntry == NULL)
+    {
+        nStatus = defaultFunc(argc, argv);
+    }
+    else
+    {
+#if CMDLINE_STATS
+        start = micros();
+#endif
+        nStatus = EntryFunc(pCmdEntry)(argc, argv);
+#if CMDLINE_STATS
+        if (stats != NULL)
+        {
+            stats->Record((uint16_t)(pCmdEntry - cmdTable), (uint32_t)(micros() - start));
+        }
+#endif
+    }
+
+    if (nStatus == CMDLINE_PENDING)
+    {
+        pending.entry = (pCmdEntry == NULL) ? PENDING_DEFAULT : (uint16_t)(pCmdEntry - cmdTable);
+        pending.argc = argc;
+    }
+    return nStatus;
+}
+
+/*
+ * NAME:
+ *  const tCmdLineEntry * FindCmd(const char * name)
+ *
+ * PARAMETERS:
+ *  const char * name = the command name to find
+ *
+ * WHAT:
+ *  Finds a command (case-insensitive) in the command table.
+ *
+ *  Uses the hash index if one has been set (see SetHashIndex()), otherwise
+ *  searches through the command table until its end (the number of table
+ *  entries or a null command string, which marks the end of the table).
+ *
+ *  The command name of the received command line is hashed by the index as
+ *  it is received (see RxChar()), so it is not hashed again here.
+ *
+ * RETURN VALUES:
+ *  const tCmdLineEntry * = pointer to the command table entry,
+ *                          NULL if the command is not found
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+const tCmdLineEntry * CommandLineBase::FindCmd(const char * name)
+{
+    PGM_P pcCmd;
+
+    if (hashIndex != NULL)
+    {
+        return hashIndex->Find(cmdTable, name, hashIndex->NameHash(CmdBuf(), name));
+    }
+
+    if (cmdTable != NULL)
+    {
+        for (uint16_t i = 0; (i < numCmds) && ((pcCmd = EntryCmd(&cmdTable[i])) != 0); ++i)
+        {
+            if (!strcasecmp_P(name, pcCmd))
+            {
+                return &cmdTable[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * NAME:
+ *  int8_t CheckArgs(const tCmdLineArgs * pArgs, int8_t argc)
+ *
+ * PARAMETERS:
+ *  const tCmdLineArgs * pArgs = the command's argument schema (in Flash)
+ *  int8_t argc = number of command line arguments (including the command itself)
+ *
+ * WHAT:
+ *  Checks the number of arguments of a command and converts each argument per
+ *  its type in the argument schema, in one pass over the arguments (into the
+ *  argument values, see ArgValue(), and their hex flags, see ArgIsHex()).
+ *
+ *   CMDLINE_ARG_STR     = any string, not converted (value 0)
+ *   CMDLINE_ARG_INT     = decimal or hex numeric value
+ *   CMDLINE_ARG_HEX     = hex numeric value
+ *   CMDLINE_ARG_KEYWORD = one of the schema keywords (value is the keyword index)
+ *
+ * RETURN VALUES:
+ *  int8_t = 0 = the arguments match the schema
+ *         = CMDLINE_TOO_FEW_ARGS if there are fewer arguments than the schema minimum
+ *         = CMDLINE_TOO_MANY_ARGS if there are more arguments than the schema maximum
+ *         = CMDLINE_INVALID_ARG if an argument does not match its type
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The values of arguments that were not given are set to 0.
+ */
+int8_t CommandLineBase::CheckArgs(const tCmdLineArgs * pArgs, int8_t argc)
+{
+    const uint8_t * types = ArgsTypes(pArgs);
+    int32_t * argVals = ArgVals();
+    uint8_t * argHex = ArgHexFlags();
+    int8_t paramtype;
+    uint8_t type;
+
+    if ((argc - 1) < (int8_t)pgm_read_byte(&pArgs->minArgs))
+    {
+        return CMDLINE_TOO_FEW_ARGS;
+    }
+    if ((argc - 1) > (int8_t)pgm_read_byte(&pArgs->maxArgs))
+    {
+        return CMDLINE_TOO_MANY_ARGS;
+    }
+
+    memset(argVals, 0, maxArgs * sizeof(argVals[0]));
+    memset(argHex, 0, (maxArgs + 7) / 8);
+    for (uint8_t i = ARG1; i < (uint8_t)argc; ++i)
+    {
+        type = (types != NULL) ? pgm_read_byte(&types[i - ARG1]) : CMDLINE_ARG_STR;
+        switch (type)
+        {
+            case CMDLINE_ARG_INT:
+            case CMDLINE_ARG_HEX:
+                paramtype = ParseParam(argv[i], &argVals[i]);
+                if (paramtype == HEXVAL)
+                {
+                    argHex[i >> 3] |= (uint8_t)(1U << (i & 7));
+                    break;
+                }
+                if ((paramtype == DECVAL) && (type == CMDLINE_ARG_INT))
+                {
+                    break;
+                }
+                return CMDLINE_INVALID_ARG;
+
+            case CMDLINE_ARG_KEYWORD:
+                argVals[i] = FindKeyword(ArgsKeywords(pArgs), argv[i]);
+                if (argVals[i] < 0)
+                {
+                    return CMDLINE_INVALID_ARG;
+                }
+                break;
+
+            default:    // CMDLINE_ARG_STR
+                break;
+        }
+    }
+    return 0;
+}
+
+/*
+ * NAME:
+ *  int32_t ArgValue(uint8_t arg)
+ *
+ * PARAMETERS:
+ *  uint8_t arg = the argument number (ARG1 ... ARG9)
+ *
+ * WHAT:
+ *  Returns the converted value of an argument of the command being executed
+ *  (for a command that has an argument schema).
+ *
+ * RETURN VALUES:
+ *  int32_t = the numeric value of a CMDLINE_ARG_INT or CMDLINE_ARG_HEX argument,
+ *            the keyword index of a CMDLINE_ARG_KEYWORD argument,
+ *            0 for a CMDLINE_ARG_STR argument or an argument that was not given
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Only valid while the command function is running (on each call of a command
+ *  in progress, see CMDLINE_PENDING).
+ */
+int32_t CommandLineBase::ArgValue(uint8_t arg)
+{
+    if (!argsValid || (arg >= maxArgs))
+    {
+        return 0;
+    }
+    return ArgVals()[arg];
+}
+
+//
+// Numeric parameter parsing.
+//
+// On 32-bit little-endian targets, runs of 4 decimal/hex digits are checked and
+// converted a 32-bit word at a time (SWAR), the rest a digit at a time.
+//
+#if !defined(CMDLINE_PARSE_SWAR) && !defined(__AVR__) && \
+    defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CMDLINE_PARSE_SWAR      1
+#endif
+
+#if CMDLINE_PARSE_SWAR
+// converts 4 decimal digit characters, returns -1 if any is not a decimal digit
+static int32_t ParseDec4(const char * pc)
+{
+    uint32_t v;
+
+    memcpy(&v, pc, sizeof(v));      // (first character in the low byte)
+    if (((v & 0xF0F0F0F0) != 0x30303030) || (((v + 0x06060606) & 0xF0F0F0F0) != 0x30303030))
+    {
+        return -1;
+    }
+    v -= 0x30303030;
+    v = (v * 10) + (v >> 8);        // digit pairs in bytes 0 and 2
+    return (int32_t)(((v & 0xFF) * 100) + ((v >> 16) & 0xFF));
+}
+
+// converts 4 hex digit characters, returns -1 if any is not a hex digit
+static int32_t ParseHex4(const char * pc)
+{
+    uint32_t v;
+    uint32_t lower;
+    uint32_t digit;
+    uint32_t alpha;
+
+    memcpy(&v, pc, sizeof(v));      // (first character in the low byte)
+    if (v & 0x80808080)
+    {
+        return -1;
+    }
+    // high bit of each byte set if the byte is in '0'-'9' / 'a'-'f' (or 'A'-'F')
+    digit = (v + 0x50505050) & ~(v + 0x46464646) & 0x80808080;
+    lower = v | 0x20202020;
+    alpha = (lower + 0x1F1F1F1F) & ~(lower + 0x19191919) & 0x80808080;
+    if ((digit | alpha) != 0x80808080)
+    {
+        return -1;
+    }
+    v = (v & 0x0F0F0F0F) + ((alpha >> 7) * 9);  // nibble values
+    v = (v << 4) | (v >> 8);                    // nibble pairs in bytes 0 and 2
+    return (int32_t)(((v & 0xFF) << 8) | ((v >> 16) & 0xFF));
+}
+#endif
+
+// returns the value of a hex digit character, -1 if not a hex digit
+static int8_t HexDigit(char ch)
+{
+    if ((ch >= '0') && (ch <= '9'))
+    {
+        return ch - '0';
+    }
+    ch |= 0x20;     // lower case
+    if ((ch >= 'a') && (ch <= 'f'))
+    {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+// parses a parameter string into a numeric magnitude and sign (see ParseParam())
+//  posLimit = largest positive decimal value, negLimit = largest negative decimal
+//  magnitude (0 = negative values not allowed), hex values are a bit pattern the size of U
+template<typename U>
+static int8_t ParseNumber(char * param, U posLimit, U negLimit, U * mag, bool * neg)
+{
+    const uint8_t safeDigits = (sizeof(U) > 4) ? 18 : 9;   // decimal digits that can not overflow
+    const char * pc = param;
+    size_t len;
+    size_t n;
+    U val = 0;
+    U limit = posLimit;
+    int32_t chunk;
+    uint8_t d;
+
+    // skip leading whitespace
+    while ((*pc != '\0') && isspace((int)*pc))
+    {
+        ++pc;
+    }
+    len = strlen(pc);
+
+    // test for string parameter
+    if (pc[0] == '\"')                     // starts with '"'
+    {
+        if (pc[len - 1] == '\"')           // ends with '"'
+        {
+            return STRVAL;
+        }
+        return BADPARAM;        // bad parameter
+    }
+
+    *neg = false;
+
+    // test for/convert hex parameter
+    if ((pc[0] == '0') && ((pc[1] | 0x20) == 'x'))     // starts with "0x"
+    {
+        pc += 2;
+        len -= 2;
+        if (len == 0)
+        {
+            return BADPARAM;    // no digits
+        }
+        while ((len > 1) && (*pc == '0'))   // skip leading zeros
+        {
+            ++pc;
+            --len;
+        }
+        if (len > (sizeof(U) * 2))
+        {
+            return BADPARAM;    // too many digits (overflow)
+        }
+#if CMDLINE_PARSE_SWAR
+        for ( ; len >= 4; pc += 4, len -= 4)
+        {
+            chunk = ParseHex4(pc);
+            if (chunk < 0)
+            {
+                return BADPARAM;
+            }
+            val = (U)((val << 16) | (U)chunk);
+        }
+#endif
+        for ( ; len > 0; ++pc, --len)
+        {
+            chunk = HexDigit(*pc);
+            if (chunk < 0)
+            {
+                return BADPARAM;
+            }
+            val = (U)((val << 4) | (U)chunk);
+        }
+        *mag = val;
+        return HEXVAL;
+    }
+
+    // test for negative parameter
+    if (pc[0] == '-')
+    {
+        if (negLimit == 0)
+        {
+            return BADPARAM;    // negative not allowed
+        }
+        *neg = true;
+        limit = negLimit;
+        ++pc;
+        --len;
+    }
+    if (len == 0)
+    {
+        return BADPARAM;        // no digits
+    }
+    while ((len > 1) && (*pc == '0'))   // skip leading zeros
+    {
+        ++pc;
+        --len;
+    }
+
+    // convert the digits that can not overflow
+    n = (len < safeDigits) ? len : safeDigits;
+    len -= n;
+#if CMDLINE_PARSE_SWAR
+    for ( ; n >= 4; pc += 4, n -= 4)
+    {
+        chunk = ParseDec4(pc);
+        if (chunk < 0)
+        {
+            return BADPARAM;
+        }
+        val = (U)((val * 10000) + (U)chunk);
+    }
+#endif
+    for ( ; n > 0; ++pc, --n)
+    {
+        d = (uint8_t)(*pc - '0');
+        if (d > 9)
+        {
+            return BADPARAM;
+        }
+        val = (U)((val * 10) + d);
+    }
+
+    // convert the rest of the digits, checking for overflow
+    for ( ; len > 0; ++pc, --len)
+    {
+        d = (uint8_t)(*pc - '0');
+        if (d > 9)
+        {
+            return BADPARAM;
+        }
+        if ((val > (limit / 10)) || ((val == (limit / 10)) && (d > (limit % 10))))
+        {
+            return BADPARAM;    // overflow
+        }
+        val = (U)((val * 10) + d);
+    }
+    *mag = val;
+    return DECVAL;
+}
+
+/*
+ * NAME:
+ *  bool ArgIsHex(uint8_t arg)
+ *
+ * PARAMETERS:
+ *  uint8_t arg = the argument number (ARG1 ... ARG9)
+ *
+ * WHAT:
+ *  Returns whether a numeric argument of the command being executed was
+ *  given in hex (for a command that has an argument schema).
+ *
+ * RETURN VALUES:
+ *  bool = true = a CMDLINE_ARG_INT or CMDLINE_ARG_HEX argument given in hex ("0x1f")
+ *         false = any other argument (or an argument that was not given)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Only valid while the command function is running.
+ */
+bool CommandLineBase::ArgIsHex(uint8_t arg)
+{
+    if (!argsValid || (arg >= maxArgs))
+    {
+        return false;
+    }
+    return ((ArgHexFlags()[arg >> 3] >> (arg & 7)) & 1) != 0;
+}
+
+/*
+ * NAME:
+ *  int8_t ParseParam(char * param, int32_t * retval)
+ *
+ * PARAMETERS:
+ *  char * param = parameter string to parse
+ *  int32_t * retval = place for parsed numeric value (if type DECVAL or HEXVAL)
+ *
+ * WHAT:
+ *  Support routine that parses a parameter string into a decimal or hex
+ *  numeric value or identifies it as a quoted string.
+ *
+ *  Decimal values must be in the range -2147483648 to 2147483647.
+ *  Hex values (up to 8 digits) are returned as their bit pattern.
+ *
+ * RETURN VALUES:
+ *  int8_t = type of parameter
+ *            - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
+ *            - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
+ *            - STRVAL   = string parameter value ("quoted string")
+ *            - BADPARAM = bad parameter (or out of range value, *retval is not changed)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line processor (CmdLineProcess()) does *not* keep the contents
+ *  of a quoted string intact. Each word in the string (a space is considered a
+ *  word delimiter - TABs are not) is placed in a separate argument! (The argument
+ *  with the first word in the quoted string contains the opening quote and the
+ *  argument with the last word in the quoted string contains the closing quote.)
+ */
+int8_t CommandLineBase::ParseParam(char * param, int32_t * retval)
+{
+    uint32_t mag;
+    bool neg;
+    int8_t type;
+
+    type = ParseNumber<uint32_t>(param, 0x7FFFFFFFUL, 0x80000000UL, &mag, &neg);
+    if ((type == DECVAL) || (type == HEXVAL))
+    {
+        *retval = (int32_t)(neg ? (0UL - mag) : mag);   // return numeric value
+    }
+    return type;
+}
+
+/*
+ * NAME:
+ *  int8_t ParseParam(char * param, uint32_t * retval)
+ *
+ * PARAMETERS:
+ *  char * param = parameter string to parse
+ *  uint32_t * retval = place for parsed numeric value (if type DECVAL or HEXVAL)
+ *
+ * WHAT:
+ *  Support routine that parses a parameter string into a decimal or hex
+ *  numeric value or identifies it as a quoted string.
+ *
+ *  Decimal values must be in the range 0 to 4294967295.
+ *  Hex values (up to 8 digits) are returned as their bit pattern. (No negative values.)
+ *
+ * RETURN VALUES:
+ *  int8_t = type of parameter
+ *            - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
+ *            - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
+ *            - STRVAL   = string parameter value ("quoted string")
+ *            - BADPARAM = bad parameter (or out of range value, *retval is not changed)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line processor (CmdLineProcess()) does *not* keep the contents
+ *  of a quoted string intact. Each word in the string (a space is considered a
+ *  word delimiter - TABs are not) is placed in a separate argument! (The argument
+ *  with the first word in the quoted string contains the opening quote and the
+ *  argument with the last word in the quoted string contains the closing quote.)
+ */
+int8_t CommandLineBase::ParseParam(char * param, uint32_t * retval)
+{
+    uint32_t mag;
+    bool neg;
+    int8_t type;
+
+    type = ParseNumber<uint32_t>(param, 0xFFFFFFFFUL, 0, &mag, &neg);
+    if ((type == DECVAL) || (type == HEXVAL))
+    {
+        *retval = mag;          // return numeric value
+    }
+    return type;
+}
+
+/*
+ * NAME:
+ *  int8_t ParseParam(char * param, int64_t * retval)
+ *
+ * PARAMETERS:
+ *  char * param = parameter string to parse
+ *  int64_t * retval = place for parsed numeric value (if type DECVAL or HEXVAL)
+ *
+ * WHAT:
+ *  Support routine that parses a parameter string into a decimal or hex
+ *  numeric value or identifies it as a quoted string.
+ *
+ *  Decimal values must be in the range -9223372036854775808 to 9223372036854775807.
+ *  Hex values (up to 16 digits) are returned as their bit pattern.
+ *
+ * RETURN VALUES:
+ *  int8_t = type of parameter
+ *            - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
+ *            - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
+ *            - STRVAL   = string parameter value ("quoted string")
+ *            - BADPARAM = bad parameter (or out of range value, *retval is not changed)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line processor (CmdLineProcess()) does *not* keep the contents
+ *  of a quoted string intact. Each word in the string (a space is considered a
+ *  word delimiter - TABs are not) is placed in a separate argument! (The argument
+ *  with the first word in the quoted string contains the opening quote and the
+ *  argument with the last word in the quoted string contains the closing quote.)
+ */
+int8_t CommandLineBase::ParseParam(char * param, int64_t * retval)
+{
+    uint64_t mag;
+    bool neg;
+    int8_t type;
+
+    type = ParseNumber<uint64_t>(param, 0x7FFFFFFFFFFFFFFFULL, 0x8000000000000000ULL, &mag, &neg);
+    if ((type == DECVAL) || (type == HEXVAL))
+    {
+        *retval = (int64_t)(neg ? (0ULL - mag) : mag);  // return numeric value
+    }
+    return type;
+}
+
+/*
+ * NAME:
+ *  void Echo(bool _echoEnable)
+ *
+ * PARAMETERS:
+ *  bool _echoEnable = a flag that is used to enable/disable echo of incoming characters
+ *                     (true = enable echo, false = disable echo)
+ *
+ * WHAT:
+ *  Enables/disables echo of incoming characters.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  CR/LF will not be echoed if Echo() is enabled and CrLfEcho() is disabled.
+ */
+void CommandLineBase::Echo(bool _echoEnable)
+{
+    input.echoEnable = _echoEnable;
+}
+
+/*
+ * NAME:
+ *  void CrLfEcho(bool _echoEnable)
+ *
+ * PARAMETERS:
+ *  bool _echoEnable = a flag that is used to enable/disable echo of incoming CR/LF characters
+ *                     (true = enable echo, false = disable echo)
+ *
+ * WHAT:
+ *  Enables/disables echo of incoming CR/LF characters.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  This has no effect if Echo() is disabled.
+ */
+void CommandLineBase::CrLfEcho(bool _echoEnable)
+{
+    input.crLfechoEnable = _echoEnable;
+}
+
+/*
+ * NAME:
+ *  void CrLfCommand(bool _crLfcmdEnable)
+ *
+ * PARAMETERS:
+ *  bool _crLfcmdEnable = a flag that is used to enable/disable sending CR/LF characters
+ *                        before processing a command
+ *                        (true = enable CR/LF response, false = disable CR/LF response)
+ *
+ * WHAT:
+ *  Enables/disables sending CR/LF characters before processing command.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::CrLfCommand(bool _crLfcmdEnable)
+{
+    input.crLfcmdEnable = _crLfcmdEnable;
+}
+
+/*
+ * NAME:
+ *  void BatchSeparator(char _separator, bool _stopOnError)
+ *
+ * PARAMETERS:
+ *  char _separator = the command separator character (e.g. ';'), CMDLINE_NO_BATCH = none
+ *  bool _stopOnError = a flag that the rest of a batch is skipped after a command
+ *                      returns an error (true = stop on error, false = continue on error)
+ *
+ * WHAT:
+ *  Sets the separator character for a batch of commands in one command line
+ *  (default is CMDLINE_NO_BATCH, no command batches).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The status of each command in a batch is reported (to the custom error
+ *  handler, if one is set).
+ */
+void CommandLineBase::BatchSeparator(char _separator, bool _stopOnError)
+{
+    RxArgsOff();
+    batch.separator = _separator;
+    batch.stopOnError = _stopOnError;
+}
+
+/*
+ * NAME:
+ *  void BreakChar(char _breakChar)
+ *
+ * PARAMETERS:
+ *  char _breakChar = the break character, CMDLINE_NO_BREAK = none
+ *
+ * WHAT:
+ *  Sets the break character (default is Ctrl-C) that cancels the work in
+ *  progress (see Cancel()).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Only in the text console.
+ */
+void CommandLineBase::BreakChar(char _breakChar)
+{
+    input.breakChar = _breakChar;
+}
+
+/*
+ * NAME:
+ *  void Delimiter(char _delimiter)
+ *
+ * PARAMETERS:
+ *  char _delimiter = the delimiter (or parameter separator) character
+ *
+ * WHAT:
+ *  Sets the parameter separator character to use (if other than the default space ' ').
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::Delimiter(char _delimiter)
+{
+    RxArgsOff();
+    delimiter = _delimiter;
+}
+
+/*
+ * NAME:
+ *  void Terminators(char * _terminators)
+ *
+ * PARAMETERS:
+ *  char * _terminators = the command line terminator character(s) to use (2 maximum supported)
+ *
+ * WHAT:
+ *  Sets the parameter separator character(s) to use (if other than the default '\r').
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::Terminators(char * _terminators)
+{
+    strncpy(TermChars(), _terminators, maxTerminators);
+}
+
+/*
+ * NAME:
+ *  void SetDefaultHandler(pfnCmdLine function)
+ *
+ * PARAMETERS:
+ *  pfnCmdLine function = the handler function for unknown commands
+ *
+ * WHAT:
+ *  Sets the handler function to use for unknown commands (default is none).
+ *  (i.e. commands not in command table)
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::SetDefaultHandler(pfnCmdLine function)
+{
+    defaultFunc = function;
+}
+
+/*
+ * NAME:
+ *  void SetCustomErrorHandler(pfnCustomErrs function)
+ *
+ * PARAMETERS:
+ *  pfnCustomErrs function = the custom handler function for commands errors
+ *
+ * WHAT:
+ *  Sets the custom handler function to use for commands errors (default is internal).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::SetCustomErrorHandler(pfnCustomErrs function)
+{
+    errorFunc = function;
+}
+
+/*
+ * NAME:
+ *  void ShowCommands(bool help_info_disable)
+ *
+ * PARAMETERS:
+ *  bool help_info_disable = optional flag to disable (if true) showing help information
+ *                           (default = false)
+ *
+ * WHAT:
+ *  Shows the menu commands.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ShowCommands(bool help_info_disable)
+{
+    const tCmdLineEntry * pEntry;
+    PGM_P pcCmd;
+
+    if (cmdTable == NULL)
+    {
+        return;
+    }
+
+    //
+    // Enter a loop to read each entry from the command table, starting at the
+    // beginning of the table.  The end of the table has been reached at the
+    // number of table entries or when the command name is NULL.
+    //
+    for (pEntry = &cmdTable[0]; ((pEntry - cmdTable) < numCmds) && ((pcCmd = EntryCmd(pEntry)) != 0); ++pEntry)
+    {
+        ShowEntry(pEntry, pcCmd, help_info_disable);
+    }
+}
+
+/*
+ * NAME:
+ *  void ShowCommandsAsync(bool help_info_disable)
+ *
+ * PARAMETERS:
+ *  bool help_info_disable = optional flag to disable (if true) showing help information
+ *                           (default = false)
+ *
+ * WHAT:
+ *  Starts showing the menu commands a few at a time (see ShowNext()), from
+ *  the following DoCmdLine() calls.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A listing in progress is restarted.
+ */
+void CommandLineBase::ShowCommandsAsync(bool help_info_disable)
+{
+    work.showing = (cmdTable != NULL);
+    work.showNoHelp = help_info_disable;
+    showNext = 0;
+}
+
+/*
+ * NAME:
+ *  void ShowEntry(const tCmdLineEntry * pEntry, PGM_P pcCmd, bool help_info_disable)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * pEntry = the command table entry
+ *  PGM_P pcCmd = the command name of the entry
+ *  bool help_info_disable = flag to disable (if true) showing help information
+ *
+ * WHAT:
+ *  Shows a command table entry (the command name and the brief description).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ShowEntry(const tCmdLineEntry * pEntry, PGM_P pcCmd, bool help_info_disable)
+{
+    // Print the command name and the brief description.
+    // See: http://forum.arduino.cc/index.php?topic=392256.0
+    output->print((const __FlashStringHelper *)pcCmd);
+    if (!help_info_disable)
+    {
+        output->println((const __FlashStringHelper *)EntryHelp(pEntry));
+    }
+    else
+    {
+        output->println();
+    }
+}
+
+/*
+ * NAME:
+ *  bool ShowNext(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Shows the next commands of the command listing in progress: one command,
+ *  or with an output queue, as many commands as the queue has room for (while
+ *  there is time left in the budget).
+ *
+ * RETURN VALUES:
+ *  bool = true = the listing is done
+ *         false = commands are left to show
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A command is shown when the output queue is empty even if it does not fit
+ *  (so the listing always moves on, per the queue's overflow policy).
+ */
+bool CommandLineBase::ShowNext(void)
+{
+    const tCmdLineEntry * pEntry;
+    PGM_P pcCmd;
+    uint16_t len;
+    CmdLineOutput * outQueue = input.outQueued ? static_cast<CmdLineOutput *>(output) : NULL;
+
+    do
+    {
+        pEntry = &cmdTable[showNext];
+        if ((showNext >= numCmds) || ((pcCmd = EntryCmd(pEntry)) == 0))
+        {
+            work.showing = false;
+            return true;
+        }
+
+        if (outQueue != NULL)
+        {
+            // wait for room in the output queue for the whole command line
+            len = strlen_P(pcCmd) + 2;
+            if (!work.showNoHelp)
+            {
+                len += strlen_P(EntryHelp(pEntry));
+            }
+            if ((len > outQueue->availableForWrite()) && outQueue->Queued())
+            {
+                return false;
+            }
+        }
+
+        ShowEntry(pEntry, pcCmd, work.showNoHelp);
+        ++showNext;
+    } while ((outQueue != NULL) && !OutOfTime());
+    return false;
+}
+
+/*
+ * NAME:
+ *  void SetOutput(CmdLineOutput& queue)
+ *
+ * PARAMETERS:
+ *  CmdLineOutput& queue = the output queue for the command line output
+ *
+ * WHAT:
+ *  Sets an output queue for the command line output (default is none, the
+ *  output is written to the stream).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The queued output is written by the following DoCmdLine() calls.
+ */
+void CommandLineBase::SetOutput(CmdLineOutput& queue)
+{
+    // the queue writes to the output (the output of the last output queue, if one was set)
+    queue.Begin(input.outQueued ? static_cast<CmdLineOutput *>(output)->Sink() : *output);
+    output = &queue;
+    input.outQueued = true;
+}
+
+/*
+ * NAME:
+ *  void SetOutput(Print& out)
+ *
+ * PARAMETERS:
+ *  Print& out = where the command line output is written
+ *
+ * WHAT:
+ *  Sets where the command line output is written (default is the stream).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  With an output queue, the queued output is written to 'out'.
+ */
+void CommandLineBase::SetOutput(Print& out)
+{
+    if (input.outQueued)
+    {
+        static_cast<CmdLineOutput *>(output)->Begin(out);
+    }
+    else
+    {
+        output = &out;
+    }
+}
+
+/*
+ * NAME:
+ *  void SetRxRing(CmdLineRxRing& ring)
+ *
+ * PARAMETERS:
+ *  CmdLineRxRing& ring = the receive ring (fed by an interrupt handler)
+ *
+ * WHAT:
+ *  Sets a receive ring to get the received characters from (default is none,
+ *  they are read from the stream).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The stream is still used for the output. The ring takes the place of the
+ *  stream for the input (it is not read from again).
+ */
+void CommandLineBase::SetRxRing(CmdLineRxRing& ring)
+{
+    source.rxRing = &ring;
+    input.fromRing = true;
+}
+
+/*
+ * NAME:
+ *  bool SetLineQueue(CmdLineQueue& queue)
+ *
+ * PARAMETERS:
+ *  CmdLineQueue& queue = the queue for received command lines
+ *
+ * WHAT:
+ *  Sets a queue for received command lines (default is none, one command line
+ *  is received and executed per DoCmdLine() call).
+ *
+ * RETURN VALUES:
+ *  bool = true = queue in use
+ *         false = the queue lines are too short for the command line buffer
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+bool CommandLineBase::SetLineQueue(CmdLineQueue& queue)
+{
+    if (queue.LineSize() < input.bufSize)
+    {
+        return false;
+    }
+    RxArgsOff();
+    lineQueue = &queue;
+    return true;
+}
+
+/*
+ * NAME:
+ *  void SetCommandTable(const tCmdLineEntry * table, uint16_t numCmds)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * table = the command table (in Flash)
+ *  uint16_t numCmds = the number of entries in 'table' (or CMDLINE_TABLE_UNSIZED if
+ *                     the end of the table is marked by a null command entry)
+ *
+ * WHAT:
+ *  Sets the command table for this command line (default is 'g_sCmdTable').
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A hash index in use (see SetHashIndex()) is rebuilt for the new table
+ *  (and command statistics in use are cleared).
+ */
+void CommandLineBase::SetCommandTable(const tCmdLineEntry * table, uint16_t _numCmds)
+{
+    cmdTable = table;
+    numCmds = _numCmds;
+    if (hashIndex != NULL)
+    {
+        SetHashIndex(*hashIndex);
+    }
+#if CMDLINE_STATS
+    if (stats != NULL)
+    {
+        stats->Clear();
+    }
+#endif
+}
+
+/*
+ * NAME:
+ *  bool SetHashIndex(CmdLineHashIndex& index)
+ *
+ * PARAMETERS:
+ *  CmdLineHashIndex& index = the hash index to use for command lookup
+ *
+ * WHAT:
+ *  Sets (and builds) a hash index to use for command lookup (default is none,
+ *  a linear search of the command table).
+ *
+ * RETURN VALUES:
+ *  bool = true = index in use
+ *         false = the command table does not fit the index (linear search is used)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+bool CommandLineBase::SetHashIndex(CmdLineHashIndex& index)
+{
+    if ((cmdTable != NULL) && index.Build(cmdTable, numCmds))
+    {
+        hashIndex = &index;
+        hashIndex->NameStart();     // (from the next command line)
+        return true;
+    }
+    hashIndex = NULL;
+    return false;
+}
+
+#if CMDLINE_STATS
+/*
+ * NAME:
+ *  void SetStats(CmdLineStats& _stats)
+ *
+ * PARAMETERS:
+ *  CmdLineStats& _stats = the per-command execution time statistics to keep
+ *
+ * WHAT:
+ *  Sets (and clears) the per-command execution time statistics to keep
+ *  (default is none).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::SetStats(CmdLineStats& _stats)
+{
+    _stats.Clear();
+    stats = &_stats;
+}
+
+/*
+ * NAME:
+ *  void ShowStats(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Shows the per-command execution time statistics of the commands that were
+ *  called: the call count, the min/avg/max execution times and the execution
+ *  time histogram (log 4 microsecond buckets).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ShowStats(void)
+{
+    const tCmdLineStat * pStat;
+    PGM_P pcCmd;
+
+    if ((stats == NULL) || (cmdTable == NULL))
+    {
+        return;
+    }
+
+    output->println(F("cmd: count min/avg/max us [<4 <16 <64 <256 <1k <4k <16k >=16k us]"));
+    for (uint16_t i = 0; (i < numCmds) && ((pcCmd = EntryCmd(&cmdTable[i])) != 0); ++i)
+    {
+        pStat = stats->Entry(i);
+        if (pStat == NULL)
+        {
+            break;
+        }
+        if (pStat->count == 0)
+        {
+            continue;
+        }
+
+        output->print((const __FlashStringHelper *)pcCmd);
+        output->print(F(": "));
+        output->print(pStat->count);
+        output->print(' ');
+        output->print(pStat->minMicros);
+        output->print('/');
+        output->print(pStat->totalMicros / pStat->count);
+        output->print('/');
+        output->print(pStat->maxMicros);
+        output->print(F(" ["));
+        for (uint8_t b = 0; b < CMDLINE_STATS_BUCKETS; ++b)
+        {
+            if (b)
+            {
+                output->print(' ');
+            }
+            output->print(pStat->hist[b]);
+        }
+        output->println(']');
+    }
+}
+#endif
+
+#if CMDLINE_COUNTERS
+/*
+ * NAME:
+ *  void ClearCounters(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Clears the receive path counters.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ClearCounters(void)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+/*
+ * NAME:
+ *  void ShowCounters(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Shows the receive path counters.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CommandLineBase::ShowCounters(void)
+{
+    output->print(F("bytes in: "));
+    output->println(counters.bytesIn);
+    output->print(F("bytes echoed: "));
+    output->println(counters.bytesEchoed);
+    output->print(F("lines: "));
+    output->println(counters.lines);
+    output->print(F("overflows: "));
+    output->println(counters.overflows);
+    output->print(F("backspaces: "));
+    output->println(counters.backspaces);
+    output->print(F("bad commands: "));
+    output->println(counters.badCmds);
+    output->print(F("max line length: "));
+    output->print(counters.maxLineLen);
+    output->print('/');
+    output->println(input.bufSize - 1);
+}
+#endif
+
+/*
+ * NAME:
+ *  void Push(const char * pcLine, uint16_t len, bool crLf)
+ *
+ * PARAMETERS:
+ *  const char * pcLine = the command line
+ *  uint16_t len = the length of the command line
+ *  bool crLf = a flag that the command line was ended by a CR or LF character
+ *
+ * WHAT:
+ *  Adds a command line to the end of the queue.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The queue must not be full (see Full()).
+ */
+void CmdLineQueue::Push(const char * pcLine, uint16_t len, bool crLf)
+{
+    uint16_t slot = (uint16_t)head + count;     // (head + count can be over 255)
+    char * pcSlot;
+
+    if (slot >= lines)
+    {
+        slot -= lines;
+    }
+    pcSlot = &buf[slot * slotSize];
+    pcSlot[0] = crLf;
+    memcpy(&pcSlot[1], pcLine, len);
+    pcSlot[len + 1] = '\0';
+    ++count;
+}
+
+/*
+ * NAME:
+ *  char * Front(bool * crLf)
+ *
+ * PARAMETERS:
+ *  bool * crLf = place for the flag that the command line was ended by a CR or LF character
+ *
+ * WHAT:
+ *  Returns the command line at the front of the queue.
+ *
+ * RETURN VALUES:
+ *  char * = the command line, NULL if the queue is empty
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The command line stays in the queue until removed (see Pop()).
+ */
+char * CmdLineQueue::Front(bool * crLf)
+{
+    char * pcSlot;
+
+    if (count == 0)
+    {
+        return NULL;
+    }
+    pcSlot = &buf[(uint16_t)head * slotSize];
+    *crLf = (pcSlot[0] != 0);
+    return &pcSlot[1];
+}
+
+/*
+ * NAME:
+ *  void Pop(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Removes the command line at the front of the queue.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+void CmdLineQueue::Pop(void)
+{
+    if (count)
+    {
+        --count;
+        if (++head >= lines)
+        {
+            head = 0;
+        }
+    }
+}
+
+/*
+ * NAME:
+ *  CmdLineHashIndex(uint16_t * heads, uint16_t buckets, uint16_t * links, uint16_t maxCmds)
+ *
+ * PARAMETERS:
+ *  uint16_t * heads = array of bucket heads
+ *  uint16_t buckets = number of buckets in 'heads' (must be a power of 2)
+ *  uint16_t * links = array of bucket chain links (one per command)
+ *  uint16_t maxCmds = number of entries in 'links'
+ *
+ * WHAT:
+ *  A constructor that sets up the hash index storage.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  The index can not be used until it is built (see Build()).
+ */
+CmdLineHashIndex::CmdLineHashIndex(uint16_t * _heads, uint16_t _buckets, uint16_t * _links, uint16_t _maxCmds) :
+    heads(_heads), links(_links), bucketMask(_buckets - 1), maxCmds(_maxCmds)
+{
+    NameStart();
+}
+
+/*
+ * NAME:
+ *  bool Build(const tCmdLineEntry * table, uint16_t numCmds)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * table = the command table (in Flash) to index
+ *  uint16_t numCmds = the number of entries in 'table' (or CMDLINE_TABLE_UNSIZED)
+ *
+ * WHAT:
+ *  Builds the hash index for a command table.
+ *
+ *  Each command name is hashed and its table index is added to the chain for
+ *  its bucket. The chains are kept in table order so duplicate command names
+ *  resolve to the first one in the table (the same as a linear search).
+ *
+ * RETURN VALUES:
+ *  bool = true = index built
+ *         false = the table has more than 'maxCmds' commands
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+bool CmdLineHashIndex::Build(const tCmdLineEntry * table, uint16_t numCmds)
+{
+    uint16_t count = 0;
+    uint16_t bucket;
+    PGM_P pcCmd;
+
+    // count the commands
+    while ((count < numCmds) && (EntryCmd(&table[count]) != 0))
+    {
+        if (++count > maxCmds)
+        {
+            return false;
+        }
+    }
+
+    for (uint16_t i = 0; i <= bucketMask; ++i)
+    {
+        heads[i] = CMDLINE_HASH_EMPTY;
+    }
+
+    // add the commands last to first so each chain is in table order
+    while (count--)
+    {
+        uint16_t hash = 0;
+
+        pcCmd = EntryCmd(&table[count]);
+        for (char ch = (char)pgm_read_byte(pcCmd); ch != '\0'; ch = (char)pgm_read_byte(++pcCmd))
+        {
+            hash = CmdLineHashStep(hash, ch);
+        }
+        bucket = Bucket(hash);
+        links[count] = heads[bucket];
+        heads[bucket] = count;
+    }
+    return true;
+}
+
+/*
+ * NAME:
+ *  const tCmdLineEntry * Find(const tCmdLineEntry * table, const char * name, uint16_t hash)
+ *
+ * PARAMETERS:
+ *  const tCmdLineEntry * table = the command table (in Flash) the index was built for
+ *  const char * name = the command name to find
+ *  uint16_t hash = the hash of 'name'
+ *
+ * WHAT:
+ *  Finds a command (case-insensitive) in the indexed command table.
+ *
+ * RETURN VALUES:
+ *  const tCmdLineEntry * = pointer to the command table entry,
+ *                          NULL if the command is not found
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+const tCmdLineEntry * CmdLineHashIndex::Find(const tCmdLineEntry * table, const char * name, uint16_t hash) const
+{
+    for (uint16_t i = heads[Bucket(hash)]; i != CMDLINE_HASH_EMPTY; i = links[i])
+    {
+        if (!strcasecmp_P(name, EntryCmd(&table[i])))
+        {
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * NAME:
+ *  uint16_t Hash(const char * name)
+ *
+ * PARAMETERS:
+ *  const char * name = the command name
+ *
+ * WHAT:
+ *  Returns the (case-insensitive) hash of a command name.
+ *
+ * RETURN VALUES:
+ *  uint16_t = the hash
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+uint16_t CmdLineHashIndex::Hash(const char * name)
+{
+    uint16_t hash = 0;
+
+    while (*name)
+    {
+        hash = CmdLineHashStep(hash, *name++);
+    }
+    return hash;
+}
 
-    //
-    // Fall through to here means that no matching command was found, so return
-    // an error or call a configured default command handler.
-    //
-    if (defaultFunc == NULL)
+/*
+ * NAME:
+ *  void NameRemove(uint16_t pos, char ch)
+ *
+ * PARAMETERS:
+ *  uint16_t pos = the position of the character in the command line
+ *  char ch = the character
+ *
+ * WHAT:
+ *  Removes the last received character (by a backspace) from the hash of the
+ *  command name (undoes NameAdd()).
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  A removed character after the name only opens the name again if it ended it.
+ */
+void CmdLineHashIndex::NameRemove(uint16_t pos, char ch)
+{
+    if (rxName.start == CMDLINE_HASH_EMPTY)
     {
-        return CMDLINE_BAD_CMD;
+        return;
     }
-    else
+    if (rxName.end != CMDLINE_HASH_EMPTY)
+    {
+        if (pos == rxName.end)
+        {
+            rxName.end = CMDLINE_HASH_EMPTY;    // the name is open again
+        }
+        return;
+    }
+    rxName.hash = CmdLineHashUnstep(rxName.hash, ch);
+    if (pos == rxName.start)
     {
-        return defaultFunc(argc, argv);
+        rxName.start = CMDLINE_HASH_EMPTY;
     }
 }
 
+
 /*
  * NAME:
- *  int8_t ParseParam(char * param, int32_t * retval)
+ *  bool Poll(void)
  *
  * PARAMETERS:
- *  char * param = parameter string to parse
- *  int32_t * retval = place for parsed numeric value (if type DECVAL or HEXVAL)
+ *  None.
  *
  * WHAT:
- *  Support routine that parses a parameter string into a decimal or hex
- *  numeric value or identifies it as a quoted string.
+ *  Writes as much of the queued output as the stream has room for
+ *  (see availableForWrite()).
  *
  * RETURN VALUES:
- *  int8_t = type of parameter
- *            - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
- *            - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
- *            - STRVAL   = string parameter value ("quoted string")
- *            - BADPARAM = bad parameter
+ *  bool = true = the queue is empty
+ *         false = output is left in the queue
  *
  * SPECIAL CONSIDERATIONS:
- *  The command line processor (CmdLineProcess()) does *not* keep the contents
- *  of a quoted string intact. Each word in the string (a space is considered a
- *  word delimiter - TABs are not) is placed in a separate argument! (The argument
- *  with the first word in the quoted string contains the opening quote and the
- *  argument with the last word in the quoted string contains the closing quote.)
+ *  None.
  */
-int8_t CommandLine::ParseParam(char * param, int32_t * retval)
+bool CmdLineOutput::Poll(void)
 {
-    int ch;
-    int32_t val = 0;
-    bool neg_val = false;
+    int room;
+    uint16_t len;
 
-    // skip leading whitespace
-    ch = *param;
-    while (ch != '\0')
+    while (count)
     {
-        if (isspace(ch))
+        room = sink->availableForWrite();
+        if (room <= 0)
         {
-            ++param;
+            return false;
         }
-        else
+
+        // the queued output up to the end of the buffer (or the room in the stream)
+        len = size - head;
+        if (len > count)
         {
-            break;
+            len = count;
         }
-        ch = *param;
-    }
-
-    // test for string parameter
-    if (param[0] == '\"')                       // starts with '"'
-    {
-        if (param[strlen(param) - 1] == '\"')   // ends with '"'
+        if (len > (unsigned int)room)
         {
-            return STRVAL;
+            len = (uint16_t)room;
         }
-        else
+
+        sink->write(&buf[head], len);
+        head += len;
+        if (head >= size)
         {
-            return BADPARAM;        // bad parameter
+            head = 0;
         }
+        count -= len;
     }
+    return true;
+}
 
-    // test for/convert hex parameter
-    if (param[0] == '0')
+/*
+ * NAME:
+ *  void Flush(void)
+ *
+ * PARAMETERS:
+ *  None.
+ *
+ * WHAT:
+ *  Writes all of the queued output.
+ *
+ * RETURN VALUES:
+ *  None.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Waits for the stream (as its write() does when its transmit buffer is full).
+ */
+void CmdLineOutput::Flush(void)
+{
+    uint16_t len;
+
+    while (count)
     {
-        if (tolower((int)param[1]) == 'x')   // starts with "0x"
+        len = size - head;
+        if (len > count)
         {
-            param += 2;
-            for (uint8_t i = 0; i < strlen(param); ++i)
-            {
-                ch = toupper((int)param[i]);
-                if (isxdigit(ch))
-                {
-                    val *= 16;
-                    if (isdigit(ch))
-                    {
-                        val += (ch - '0');
-                    }
-                    else
-                    {
-                        val += (ch - 'A') + 10;
-                    }
-                }
-                else
-                {
-                    return BADPARAM;    // bad parameter
-                }
-            }
-            *retval = val;          // return numeric value
-            return HEXVAL;
+            len = count;
+        }
+        sink->write(&buf[head], len);
+        head += len;
+        if (head >= size)
+        {
+            head = 0;
         }
+        count -= len;
     }
+}
 
-    // test for negative parameter
-    if (param[0] == '-')
+/*
+ * NAME:
+ *  size_t write(uint8_t ch)
+ *
+ * PARAMETERS:
+ *  uint8_t ch = the output character
+ *
+ * WHAT:
+ *  Writes a character to the stream (or queues it).
+ *
+ * RETURN VALUES:
+ *  size_t = 1 = the character was written or queued
+ *           0 = the character was dropped
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+size_t CmdLineOutput::write(uint8_t ch)
+{
+    return write(&ch, 1);
+}
+
+/*
+ * NAME:
+ *  size_t write(const uint8_t * buffer, size_t len)
+ *
+ * PARAMETERS:
+ *  const uint8_t * buffer = the output characters
+ *  size_t len = the number of characters in 'buffer'
+ *
+ * WHAT:
+ *  Writes output characters to the stream, as far as the stream has room for
+ *  them (and nothing is queued ahead of them), and queues the rest.
+ *
+ *  When the queue is full, the rest of the characters are dropped (the
+ *  CMDLINE_OUTPUT_DROP policy), or the queue is written to the stream, waiting
+ *  for it (the CMDLINE_OUTPUT_BLOCK policy).
+ *
+ * RETURN VALUES:
+ *  size_t = the number of characters written or queued
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+size_t CmdLineOutput::write(const uint8_t * buffer, size_t len)
+{
+    size_t n = 0;
+    size_t chunk;
+    uint16_t tail;
+    int room;
+
+    if (sink == NULL)
     {
-        neg_val = true;     // negative
-        ++param;
+        return 0;
     }
 
-    // test for numeric parameter
-    else if (!isdigit((int)param[0]))
+    //
+    // Write straight to the stream what it has room for (only when nothing is
+    // queued, to keep the output in order).
+    //
+    if (count)
     {
-        return BADPARAM;        // bad parameter
+        Poll();
+    }
+    if (count == 0)
+    {
+        room = sink->availableForWrite();
+        if (room > 0)
+        {
+            n = ((size_t)room < len) ? (size_t)room : len;
+            sink->write(buffer, n);
+        }
     }
 
-    // test for/convert decimal parameter
-    for (uint8_t i = 0; i < strlen(param); ++i)
+    //
+    // Queue the rest.
+    //
+    while (n < len)
     {
-        ch = (int)param[i];
-        if (isdigit(ch))
+        if (count >= size)
         {
-            val *= 10;
-            val += (ch - '0');
+            if (policy != CMDLINE_OUTPUT_BLOCK)
+            {
+                dropped += len - n;
+                break;
+            }
+            Flush();
         }
-        else
+        tail = Tail();
+        chunk = (tail >= head) ? (size_t)(size - tail) : (size_t)(head - tail);
+        if (chunk > (len - n))
         {
-            return BADPARAM;    // bad parameter
+            chunk = len - n;
         }
+        memcpy(&buf[tail], &buffer[n], chunk);
+        count += chunk;
+        n += chunk;
+    }
+    return n;
+}
+
+/*
+ * NAME:
+ *  uint16_t CmdLineRxRing::Put(const uint8_t * data, uint16_t len)
+ *
+ * PARAMETERS:
+ *  const uint8_t * data = the received bytes
+ *  uint16_t len = the number of bytes
+ *
+ * WHAT:
+ *  Adds a block of received bytes to the ring (the producer side).
+ *
+ *  The bytes are made visible to the consumer all at once (one release store
+ *  of the head index).
+ *
+ * RETURN VALUES:
+ *  uint16_t = the number of bytes added (the rest are dropped and counted as overruns)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  Safe to call from an interrupt handler (the only producer).
+ */
+uint16_t CmdLineRxRing::Put(const uint8_t * data, uint16_t len)
+{
+    tCmdLineRingIndex pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    tCmdLineRingIndex end = (tCmdLineRingIndex)((__atomic_load_n(&tail, __ATOMIC_ACQUIRE) - 1) & mask);
+    uint16_t n = 0;
+
+    while ((n < len) && (pos != end))
+    {
+        buf[pos] = data[n++];
+        pos = (tCmdLineRingIndex)((pos + 1) & mask);
     }
-    if (neg_val)
+    __atomic_store_n(&head, pos, __ATOMIC_RELEASE);
+    if (n < len)
     {
-        val = 0 - val;
+        overruns += len - n;
     }
-    *retval = val;          // return numeric value
-    return DECVAL;
+    return n;
 }
 
 /*
  * NAME:
- *  void Echo(bool _echoEnable)
+ *  uint16_t CmdLineRxRing::Get(uint8_t * data, uint16_t len)
  *
  * PARAMETERS:
- *  bool _echoEnable = a flag that is used to enable/disable echo of incoming characters
- *                     (true = enable echo, false = disable echo)
+ *  uint8_t * data = the place for the bytes
+ *  uint16_t len = the maximum number of bytes
  *
  * WHAT:
- *  Enables/disables echo of incoming characters.
+ *  Takes received bytes out of the ring (the consumer side).
  *
  * RETURN VALUES:
- *  None.
+ *  uint16_t = the number of bytes taken out
  *
  * SPECIAL CONSIDERATIONS:
- *  CR/LF will not be echoed if Echo() is enabled and CrLfEcho() is disabled.
+ *  The room is given back to the producer all at once (one release store of
+ *  the tail index).
  */
-void CommandLine::Echo(bool _echoEnable)
+uint16_t CmdLineRxRing::Get(uint8_t * data, uint16_t len)
 {
-    input.echoEnable = _echoEnable;
+    tCmdLineRingIndex pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    tCmdLineRingIndex end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint16_t n = 0;
+
+    while ((n < len) && (pos != end))
+    {
+        data[n++] = buf[pos];
+        pos = (tCmdLineRingIndex)((pos + 1) & mask);
+    }
+    __atomic_store_n(&tail, pos, __ATOMIC_RELEASE);
+    return n;
 }
 
 /*
  * NAME:
- *  void CrLfEcho(bool _echoEnable)
+ *  bool CmdLineTee::Add(Print& sink)
  *
  * PARAMETERS:
- *  bool _echoEnable = a flag that is used to enable/disable echo of incoming CR/LF characters
- *                     (true = enable echo, false = disable echo)
+ *  Print& sink = the output to add
  *
  * WHAT:
- *  Enables/disables echo of incoming CR/LF characters.
+ *  Adds an output to the output mirror.
  *
  * RETURN VALUES:
- *  None.
+ *  bool = true = added
+ *         false = the list of outputs is full
  *
  * SPECIAL CONSIDERATIONS:
- *  This has no effect if Echo() is disabled.
+ *  The first output added is the primary output (its write count is returned).
  */
-void CommandLine::CrLfEcho(bool _echoEnable)
+bool CmdLineTee::Add(Print& sink)
 {
-    input.crLfechoEnable = _echoEnable;
+    if (count >= maxSinks)
+    {
+        return false;
+    }
+    sinks[count++] = &sink;
+    return true;
 }
 
 /*
  * NAME:
- *  void CrLfCommand(bool _crLfcmdEnable)
+ *  size_t CmdLineTee::write(uint8_t ch)
  *
  * PARAMETERS:
- *  bool _crLfcmdEnable = a flag that is used to enable/disable sending CR/LF characters
- *                        before processing a command
- *                        (true = enable CR/LF response, false = disable CR/LF response)
+ *  uint8_t ch = the character to write
  *
  * WHAT:
- *  Enables/disables sending CR/LF characters before processing command.
+ *  Writes a character to all of the outputs.
  *
  * RETURN VALUES:
- *  None.
+ *  size_t = the number of characters written (to the primary output)
  *
  * SPECIAL CONSIDERATIONS:
  *  None.
  */
-void CommandLine::CrLfCommand(bool _crLfcmdEnable)
+size_t CmdLineTee::write(uint8_t ch)
 {
-    input.crLfcmdEnable = _crLfcmdEnable;
+    size_t n;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    n = sinks[0]->write(ch);
+    for (uint8_t i = 1; i < count; ++i)
+    {
+        sinks[i]->write(ch);
+    }
+    return n;
 }
 
 /*
  * NAME:
- *  void Delimiter(char _delimiter)
+ *  size_t CmdLineTee::write(const uint8_t * buffer, size_t len)
  *
  * PARAMETERS:
- *  char _delimiter = the delimiter (or parameter separator) character
+ *  const uint8_t * buffer = the characters to write
+ *  size_t len = the number of characters
  *
  * WHAT:
- *  Sets the parameter separator character to use (if other than the default space ' ').
+ *  Writes a block of characters to all of the outputs (the same buffer is
+ *  passed to each, it is not copied).
  *
  * RETURN VALUES:
- *  None.
+ *  size_t = the number of characters written (to the primary output)
  *
  * SPECIAL CONSIDERATIONS:
  *  None.
  */
-void CommandLine::Delimiter(char _delimiter)
+size_t CmdLineTee::write(const uint8_t * buffer, size_t len)
 {
-    delimiter = _delimiter;
+    size_t n;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    n = sinks[0]->write(buffer, len);
+    for (uint8_t i = 1; i < count; ++i)
+    {
+        sinks[i]->write(buffer, len);
+    }
+    return n;
 }
 
 /*
  * NAME:
- *  void Terminators(char * _terminators)
+ *  int CmdLineTee::availableForWrite(void)
  *
  * PARAMETERS:
- *  char * _terminators = the command line terminator character(s) to use (2 maximum supported)
+ *  None.
  *
  * WHAT:
- *  Sets the parameter separator character(s) to use (if other than the default '\r').
+ *  Returns the room for output (the smallest room of the outputs).
  *
  * RETURN VALUES:
- *  None.
+ *  int = the number of characters that can be written without blocking
  *
  * SPECIAL CONSIDERATIONS:
  *  None.
  */
-void CommandLine::Terminators(char * _terminators)
+int CmdLineTee::availableForWrite(void)
 {
-    strncpy(terminators, _terminators, CMDLINE_MAX_TERMINATORS);
+    int least = 0;
+    int room;
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        room = sinks[i]->availableForWrite();
+        if ((i == 0) || (room < least))
+        {
+            least = room;
+        }
+    }
+    return least;
 }
 
+#if CMDLINE_STATS
 /*
  * NAME:
- *  void SetDefaultHandler(pfnCmdLine function)
+ *  CmdLineStats(tCmdLineStat * entries, uint16_t maxCmds)
  *
  * PARAMETERS:
- *  pfnCmdLine function = the handler function for unknown commands
+ *  tCmdLineStat * entries = array of command statistics (one per command)
+ *  uint16_t maxCmds = number of entries in 'entries'
  *
  * WHAT:
- *  Sets the handler function to use for unknown commands (default is none).
- *  (i.e. commands not in command table)
+ *  A constructor that sets up the command statistics storage.
  *
  * RETURN VALUES:
  *  None.
@@ -654,20 +4122,21 @@ void CommandLine::Terminators(char * _terminators)
  * SPECIAL CONSIDERATIONS:
  *  None.
  */
-void CommandLine::SetDefaultHandler(pfnCmdLine function)
+CmdLineStats::CmdLineStats(tCmdLineStat * _entries, uint16_t _maxCmds) :
+    entries(_entries), maxCmds(_maxCmds)
 {
-    defaultFunc = function;
+    Clear();
 }
 
 /*
  * NAME:
- *  void SetCustomErrorHandler(pfnCustomErrs function)
+ *  void Clear(void)
  *
  * PARAMETERS:
- *  pfnCustomErrs function = the custom handler function for commands errors
+ *  None.
  *
  * WHAT:
- *  Sets the custom handler function to use for commands errors (default is internal).
+ *  Clears the statistics of all of the commands.
  *
  * RETURN VALUES:
  *  None.
@@ -675,82 +4144,84 @@ void CommandLine::SetDefaultHandler(pfnCmdLine function)
  * SPECIAL CONSIDERATIONS:
  *  None.
  */
-void CommandLine::SetCustomErrorHandler(pfnCustomErrs function)
+void CmdLineStats::Clear(void)
 {
-    errorFunc = function;
+    memset(entries, 0, (size_t)maxCmds * sizeof(tCmdLineStat));
 }
 
 /*
  * NAME:
- *  void ShowCommands(bool help_info_disable)
+ *  void Record(uint16_t cmd, uint32_t us)
  *
  * PARAMETERS:
- *  bool help_info_disable = optional flag to disable (if true) showing help information
- *                           (default = false)
+ *  uint16_t cmd = the index of the command in the command table
+ *  uint32_t us = the execution time in microseconds
  *
  * WHAT:
- *  Shows the menu commands.
+ *  Records an execution time of a command.
  *
  * RETURN VALUES:
  *  None.
  *
  * SPECIAL CONSIDERATIONS:
- *  None.
+ *  Commands past the end of the statistics storage are not recorded.
+ *  The histogram counts stop at 0xffff (the total time wraps after about 71 minutes).
  */
-void CommandLine::ShowCommands(bool help_info_disable)
+void CmdLineStats::Record(uint16_t cmd, uint32_t us)
 {
-    tCmdLineEntry * pEntry;
-#ifdef ESP8266
-    PGM_P * pgmp;
-#endif
+    tCmdLineStat * pStat;
+    uint8_t bucket;
 
-    // Point at the beginning of the command table.
-    pEntry = (tCmdLineEntry *)&g_sCmdTable[0];
+    if (cmd >= maxCmds)
+    {
+        return;
+    }
+    pStat = &entries[cmd];
 
-    //
-    // Enter a loop to read each entry from the command table.  The
-    // end of the table has been reached when the command name is NULL.
-    //
-    while (1)
+    if ((pStat->count == 0) || (us < pStat->minMicros))
     {
-#ifdef ESP8266
-        pgmp = &(pEntry->pcCmd);    // prevents dereferencing type-punned pointer warning
-        if (pgm_read_dword(pgmp) == 0)
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-        if (pEntry->pcCmd == 0)
-#else
-        if (pgm_read_word(&pEntry->pcCmd) == 0)
-#endif
-        {
-            break;
-        }
-        // Print the command name and the brief description.
-        // See: http://forum.arduino.cc/index.php?topic=392256.0
-#ifdef ESP8266
-        serial.print((const __FlashStringHelper *)pgm_read_dword(pgmp));
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-        serial.print(pEntry->pcCmd);
-#else
-        serial.print((const __FlashStringHelper *)pgm_read_word(&(pEntry->pcCmd)));
-#endif
-        if (!help_info_disable)
-        {
-#ifdef ESP8266
-            pgmp = &(pEntry->pcHelp);   // prevents dereferencing type-punned pointer warning
-            serial.println((const __FlashStringHelper *)pgm_read_dword(pgmp));
-#elif defined(ESP32) || ((defined(TEENSYDUINO) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_MBED_RP2040)) && !defined(__AVR__))
-            serial.println(pEntry->pcHelp);
-#else
-            serial.println((const __FlashStringHelper *)pgm_read_word(&(pEntry->pcHelp)));
-#endif
-        }
-        else
-        {
-            serial.println();
-        }
+        pStat->minMicros = us;
+    }
+    if (us > pStat->maxMicros)
+    {
+        pStat->maxMicros = us;
+    }
+    ++pStat->count;
+    pStat->totalMicros += us;
 
-        // Advance to the next entry in the table.
-        ++pEntry;
+    bucket = Bucket(us);
+    if (pStat->hist[bucket] != 0xffff)
+    {
+        ++pStat->hist[bucket];
     }
 }
 
+/*
+ * NAME:
+ *  uint8_t Bucket(uint32_t us)
+ *
+ * PARAMETERS:
+ *  uint32_t us = the execution time in microseconds
+ *
+ * WHAT:
+ *  Returns the histogram bucket for an execution time (log 4 of the time,
+ *  the last bucket holds all of the longer times).
+ *
+ * RETURN VALUES:
+ *  uint8_t = the bucket (0 to CMDLINE_STATS_BUCKETS - 1)
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None.
+ */
+uint8_t CmdLineStats::Bucket(uint32_t us)
+{
+    uint8_t bucket = 0;
+
+    while ((us >= 4) && (bucket < (CMDLINE_STATS_BUCKETS - 1)))
+    {
+        us >>= 2;
+        ++bucket;
+    }
+    return bucket;
+}
+#endif // CMDLINE_STATS
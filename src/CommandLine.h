@@ -19,15 +19,76 @@
 
 #define CLS_HOME    "\033[2J"
 #define CHAR_BS     0x08
+#define CHAR_CTRL_C 0x03
 
 /**
- *  Defines the maximum number of arguments that can be parsed.
+ * Defines the size of the buffer that holds the command line (of a \ref CommandLine,
+ * see \ref CommandLineN for other sizes).
+ */
+#define CMD_BUF_SIZE            80
+
+/**
+ *  Defines the maximum number of arguments that can be parsed (by a \ref CommandLine,
+ *  see \ref CommandLineN for other sizes).
  *  (this includes the command itself plus its parameters)
  */
 #define CMDLINE_MAX_ARGS        10
 
+/**
+ *  Defines the maximum number of command line terminator characters (of a \ref CommandLine,
+ *  see \ref CommandLineN for other sizes).
+ */
 #define CMDLINE_MAX_TERMINATORS 2
 
+/**
+ *  Defines the batch separator value for no command batches (see \ref CommandLineBase::BatchSeparator()).
+ */
+#define CMDLINE_NO_BATCH        '\0'
+
+/**
+ *  Defines the break character value for no break character (see \ref CommandLineBase::BreakChar()).
+ */
+#define CMDLINE_NO_BREAK        '\0'
+
+/**
+ *  Defines the maximum number of received characters read from the stream at a time
+ *  (their echo is written from the same buffer).
+ */
+#define CMDLINE_RX_CHUNK        16
+
+/**
+ *  Defines the \e maxChars value for no limit on the received characters
+ *  processed by a DoCmdLine() call.
+ */
+#define CMDLINE_NO_LIMIT        0xffff
+
+/**
+ *  Defines the \e maxMicros value for no time limit on a DoCmdLine() call
+ *  (budgets over 0x7fffffff microseconds are cut to that).
+ */
+#define CMDLINE_NO_TIME_LIMIT   0
+
+/**
+ *  Enables the per-command execution time statistics (see \ref CmdLineStats).
+ *  (0 = disabled, the statistics code and data are not compiled)
+ *
+ *  This changes the CommandLine class layout, so it must be a global build flag
+ *  (e.g. -DCMDLINE_STATS=1 in build_opt.h or platform.local.txt), not a #define in the sketch.
+ */
+#ifndef CMDLINE_STATS
+#define CMDLINE_STATS           0
+#endif
+
+/**
+ *  Enables the receive path counters (see \ref tCmdLineCounters).
+ *  (0 = disabled, the counters code and data are not compiled)
+ *
+ *  Like \ref CMDLINE_STATS, this must be a global build flag.
+ */
+#ifndef CMDLINE_COUNTERS
+#define CMDLINE_COUNTERS        0
+#endif
+
 #define CMD         0
 #define ARG1        1
 #define ARG2        2
@@ -49,6 +110,10 @@
 
 /**
  *  Command line function callback type.
+ *
+ *  A command function that can not finish at once returns \ref CMDLINE_PENDING and
+ *  is called again (with the same arguments) by the following \ref CommandLineBase::DoCmdLine()
+ *  calls until it returns its status (see \ref CommandLineBase::CmdState()).
  */
 typedef int8_t (* pfnCmdLine)(int8_t argc, char * argv[]);
 
@@ -57,6 +122,47 @@ typedef int8_t (* pfnCmdLine)(int8_t argc, char * argv[]);
  */
 typedef void (* pfnCustomErrs)(int8_t err_code);
 
+/**
+ *  Defines of the argument types in a command argument schema (see \ref tCmdLineArgs).
+ */
+#define CMDLINE_ARG_STR         0   ///< any string (not converted)
+#define CMDLINE_ARG_INT         1   ///< decimal or hex numeric value
+#define CMDLINE_ARG_HEX         2   ///< hex numeric value
+#define CMDLINE_ARG_KEYWORD     3   ///< one of the schema keywords (converted to its index)
+
+/**
+ *  Defines the character that separates the keywords of a command argument schema ("on|off|hb").
+ */
+#define CMDLINE_KEYWORD_SEP     '|'
+
+/**
+ * Structure for the argument schema of a command (in Flash).
+ *
+ * The arguments of a command that has a schema are checked and converted
+ * before its command function is called (see \ref CommandLine::ArgValue()).
+ *
+ * Example:
+ *
+ *     const uint8_t TypesLed[] PROGMEM = { CMDLINE_ARG_KEYWORD };
+ *     const char KeywordsLed[] PROGMEM = "on|off|hb";
+ *     const tCmdLineArgs ArgsLed PROGMEM = { 0, 1, TypesLed, KeywordsLed };
+ */
+typedef struct
+{
+    /// The minimum number of arguments (not counting the command itself).
+    uint8_t minArgs;
+
+    /// The maximum number of arguments (not counting the command itself).
+    uint8_t maxArgs;
+
+    /// A pointer to the type of each argument (CMDLINE_ARG_xxx, an array in Flash of
+    /// \e maxArgs types - NULL = all arguments are CMDLINE_ARG_STR).
+    const uint8_t * types;
+
+    /// A pointer to a string of the keywords ("on|off|hb") for the CMDLINE_ARG_KEYWORD arguments.
+    PGM_P pcKeywords;
+} tCmdLineArgs;
+
 /**
  * Structure for an entry in the command list table.
  */
@@ -70,200 +176,1867 @@ typedef struct
 
     /// A pointer to a string of brief help text for the command.
     PGM_P pcHelp;
+
+    /// A pointer to the argument schema for the command (optional, NULL = the command checks its own arguments).
+    const tCmdLineArgs * pArgs;
 } tCmdLineEntry;
 
 /**
- * This is the command table that must be provided by the application.
+ * This is the default command table that is provided by the application.
+ *
+ * \note Declared weak, so an application that gives each CommandLine its own
+ * command table (see \ref CommandLineBase::SetCommandTable()) does not have to provide it.
+ */
+extern const tCmdLineEntry g_sCmdTable[] PROGMEM __attribute__((weak));
+
+/**
+ *  Defines of the command line framing modes (see \ref CommandLineBase::FrameMode()).
+ */
+#define CMDLINE_FRAME_TEXT      0   ///< text console (default)
+#define CMDLINE_FRAME_BINARY    1   ///< length-prefixed binary frames
+#define CMDLINE_FRAME_SLIP      2   ///< SLIP framed command lines (RFC 1055)
+#define CMDLINE_FRAME_COBS      3   ///< COBS framed command lines (0x00 delimited)
+
+/**
+ *  Defines the SLIP special bytes.
+ */
+#define CMDLINE_SLIP_END        0xC0
+#define CMDLINE_SLIP_ESC        0xDB
+#define CMDLINE_SLIP_ESC_END    0xDC
+#define CMDLINE_SLIP_ESC_ESC    0xDD
+
+/**
+ *  Defines the first byte of a binary frame.
+ *
+ *  A binary frame is: SYNC, LEN, command id, args..., CRC-8
+ *   - LEN = number of bytes of the command id and args (1 to \ref CMDLINE_FRAME_MAX_LEN)
+ *   - command id = index of the command in the command table
+ *   - args = each argument as a length byte followed by its characters
+ *   - CRC-8 = CRC-8 (polynomial 0x07) of the LEN, command id and args bytes
+ *
+ *  Each frame is answered with: SYNC, 2, command id, status, CRC-8
+ */
+#define CMDLINE_FRAME_SYNC      0xA5
+
+/**
+ *  Defines the binary frame command id that returns the command line to the text console.
  */
-extern const tCmdLineEntry g_sCmdTable[] PROGMEM;
+#define CMDLINE_FRAME_EXIT      0xFF
 
 /**
- * CommandLine Arduino library class. Version: "V1.10 7/7/2023"
+ *  CRC-8 (polynomial 0x07) step for the binary frame check byte (a nibble at a time).
  */
-class CommandLine
+inline uint8_t CmdLineCrc8(uint8_t crc, uint8_t data)
 {
-    public:
-        /**
-         * Defines the size of the buffer that holds the command line.
-         */
-        #define CMD_BUF_SIZE            80
+    static const uint8_t nibbleCrc[16] PROGMEM =
+    {
+        0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+    };
 
-        /// Defines the value that is returned if the command is not found.
-        #define CMDLINE_BAD_CMD         (-1)
+    crc ^= data;
+    crc = (uint8_t)(crc << 4) ^ pgm_read_byte(&nibbleCrc[crc >> 4]);
+    return (uint8_t)(crc << 4) ^ pgm_read_byte(&nibbleCrc[crc >> 4]);
+}
 
-        /// Defines the value that is returned if there are too many arguments.
-        #define CMDLINE_TOO_MANY_ARGS   (-2)
+/**
+ *  Defines the command table size for a table whose end is marked by a null command entry.
+ */
+#define CMDLINE_TABLE_UNSIZED   0xffff
 
-        /// Defines the value that is returned if there are not enough arguments.
-        #define CMDLINE_TOO_FEW_ARGS    (-3)
+/**
+ *  Folds an ASCII command name character to lower case (for case-insensitive command hashing).
+ */
+#define CMDLINE_HASH_FOLD(ch)   ((((ch) >= 'A') && ((ch) <= 'Z')) ? ((ch) + ('a' - 'A')) : (ch))
 
-        /// Defines the value that is returned if an argument is invalid.
-        #define CMDLINE_INVALID_ARG     (-4)
+/**
+ *  Command name hash step (case-insensitive): hash = (hash * 31) + folded character.
+ */
+inline uint16_t CmdLineHashStep(uint16_t hash, char ch)
+{
+    return (uint16_t)((hash * 31U) + (uint8_t)CMDLINE_HASH_FOLD(ch));
+}
+
+/**
+ *  Defines the inverse of 31 (mod 2^16), for undoing a command name hash step.
+ */
+#define CMDLINE_HASH_INV31      31711U
+
+/**
+ *  Undoes a command name hash step (the last character of the name is removed):
+ *  hash = (hash - folded character) / 31.
+ */
+inline uint16_t CmdLineHashUnstep(uint16_t hash, char ch)
+{
+    return (uint16_t)((uint16_t)(hash - (uint8_t)CMDLINE_HASH_FOLD(ch)) * CMDLINE_HASH_INV31);
+}
+
+/**
+ *  Returns the smallest power of 2 that is >= \e n (used to size hash index buckets at compile time).
+ */
+constexpr uint16_t CmdLinePow2(uint16_t n, uint16_t pow2 = 1)
+{
+    return (pow2 >= n) ? pow2 : CmdLinePow2(n, (uint16_t)(pow2 << 1));
+}
+
+/**
+ * Hash index over a command table for constant time command lookup
+ * (see \ref CommandLineBase::SetHashIndex()).
+ *
+ * The index storage is declared (and sized) at compile time with \ref CmdLineHashIndexN.
+ * The index is built once from the (Flash) command table when it is attached to a
+ * CommandLine, after which a command lookup is a hash of the command name, a bucket
+ * read and (typically) a single name compare, regardless of the number of commands.
+ *
+ * The index also hashes the command name of the command line being received, as its
+ * characters are received (see \ref NameAdd()), so an index serves one CommandLine.
+ */
+class CmdLineHashIndex
+{
+    public:
+        /// Defines the value of an empty bucket/end of a bucket chain.
+        #define CMDLINE_HASH_EMPTY      0xffff
 
-        // Constructors
         /**
-         *  A constructor that sets up the command line processing code.
+         *  A constructor that sets up the index storage.
          *
-         *  \param serial: the stream that a command line is implemented on (typically 'Serial')
-         *
-         *  \return None.
-         *
-         *  \note Defaults to enable echo of incoming characters.
+         *  \param heads: array of bucket heads
+         *  \param buckets: number of buckets in \e heads (must be a power of 2)
+         *  \param links: array of bucket chain links (one per command)
+         *  \param maxCmds: number of entries in \e links (maximum commands that can be indexed)
          */
-        CommandLine(Stream& serial);
+        CmdLineHashIndex(uint16_t * heads, uint16_t buckets, uint16_t * links, uint16_t maxCmds);
 
         /**
-         *  A constructor that sets up the command line processing code.
+         * Builds the index for a command table.
          *
-         *  \param serial: the stream that a command line is implemented on (typically 'Serial')
-         *  \param echoEnable: a flag that is used to enable/disable echo of incoming characters
-         *                    (\e true = enable echo, \e false = disable echo)
+         * \param table: the command table (in Flash) to index
+         * \param numCmds: the number of entries in \e table (or \ref CMDLINE_TABLE_UNSIZED)
          *
-         *  \return None.
+         * \return   \e true = index built, \e false = the table has more than \e maxCmds commands
          */
-        CommandLine(Stream& serial, bool echoEnable);
+        bool Build(const tCmdLineEntry * table, uint16_t numCmds);
 
         /**
-         * Implements the non-blocking serial command processing.
+         * Finds a command (case-insensitive) in the indexed command table.
          *
-         * \return   int8_t
-         * \return   0 = no command to process yet
-         * \return   1 = a command was processed
+         * \param table: the command table (in Flash) the index was built for
+         * \param name: the command name to find
+         * \param hash: the hash of \e name (see \ref CmdLineHashStep())
          *
-         *  \note This should be called in \e 'loop()' to check for/process incoming commands.
+         * \return   pointer to the command table entry, or NULL if not found
          */
-        int8_t DoCmdLine(void);
+        const tCmdLineEntry * Find(const tCmdLineEntry * table, const char * name, uint16_t hash) const;
 
         /**
-         * Support routine that parses a command parameter string into a decimal or hex
-         * numeric value or identifies it as a quoted string.
-         *
-         * \param param: parameter string to parse
-         * \param retval: place for parsed numeric value (if type DECVAL or HEXVAL)
-         *
-         * \return   type of parameter
-         * \return   - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
-         * \return   - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
-         * \return   - STRVAL   = string parameter value ("quoted string")
-         * \return   - BADPARAM = bad parameter
+         * Returns the (case-insensitive) hash of a command name.
          *
-         *  \note The command line processor (\b CmdLineProcess()) does *not* keep the contents
-         *  of a quoted string intact. Each word in the string (a space is considered a
-         *  word delimiter - TABs are not) is placed in a separate argument! (The argument
-         *  with the first word in the quoted string contains the opening quote and the
-         *  argument with the last word in the quoted string contains the closing quote.)
+         * \param name: the command name
          */
-        int8_t ParseParam(char * param, int32_t * retval);
+        static uint16_t Hash(const char * name);
 
         /**
-         * Enables/disables echo of incoming characters (default is enabled).
-         *
-         * \param echoEnable: a flag that is used to enable/disable echo of incoming characters
-         *                    (\e true = enable echo, \e false = disable echo)
-         *
-         *  \note CR/LF will not be echoed if \ref Echo() is enabled and \ref CrLfEcho() is disabled.
+         * Starts the hash of the command name of a new command line being received.
          */
-        void Echo(bool echoEnable);
+        void NameStart(void)
+        {
+            rxName.start = CMDLINE_HASH_EMPTY;
+            rxName.end = CMDLINE_HASH_EMPTY;
+        }
 
         /**
-         * Enables/disables echo of incoming CR/LF characters (default is disabled).
+         * Adds a received character to the hash of the command name (the first token of the
+         * command line being received).
          *
-         * \param crLfechoEnable: a flag that is used to enable/disable echo of incoming CR/LF characters
-         *                        (\e true = enable echo, \e false = disable echo)
-         *
-         *  \note This has no effect if \ref Echo() is disabled.
+         * \param pos: the position of the character in the command line
+         * \param ch: the character
+         * \param split: the character splits the tokens (a delimiter or the batch separator)
          */
-        void CrLfEcho(bool crLfechoEnable);
+        void NameAdd(uint16_t pos, char ch, bool split)
+        {
+            if (rxName.end != CMDLINE_HASH_EMPTY)
+            {
+                return;     // (the name has ended)
+            }
+            if (rxName.start == CMDLINE_HASH_EMPTY)
+            {
+                if (!split)
+                {
+                    rxName.start = pos;
+                    rxName.hash = CmdLineHashStep(0, ch);
+                }
+            }
+            else if (split)
+            {
+                rxName.end = pos;
+            }
+            else
+            {
+                rxName.hash = CmdLineHashStep(rxName.hash, ch);
+            }
+        }
 
         /**
-         * Enables/disables sending CR/LF characters before processing command (default is enabled).
+         * Removes the last received character (by a backspace) from the hash of the command name.
          *
-         * \param crLfcmdEnable: a flag that is used to enable/disable sending CR/LF characters
-         *                       before processing a command
-         *                       (\e true = enable CR/LF response, \e false = disable CR/LF response)
+         * \param pos: the position of the character in the command line
+         * \param ch: the character
          */
-        void CrLfCommand(bool crLfcmdEnable);
+        void NameRemove(uint16_t pos, char ch);
 
         /**
-         * Sets the parameter separator character to use (if other than the default space ' ').
+         * Returns the hash of a command name, without hashing it again if it is the received
+         * command name.
          *
-         * \param delimiter: the delimiter (or parameter separator) character
+         * \param line: the command line buffer the command name was received in
+         * \param name: the command name
          */
-        void Delimiter(char delimiter);
+        uint16_t NameHash(const char * line, const char * name) const
+        {
+            if ((rxName.start != CMDLINE_HASH_EMPTY) && (name == &line[rxName.start]))
+            {
+                return rxName.hash;
+            }
+            return Hash(name);
+        }
+
+    private:
+        uint16_t * heads;
+        uint16_t * links;
+        uint16_t bucketMask;
+        uint16_t maxCmds;
+
+        // the command name of the command line being received
+        struct
+        {
+            uint16_t start;     // its position in the command line (CMDLINE_HASH_EMPTY = none yet)
+            uint16_t end;       // the position after it (CMDLINE_HASH_EMPTY = not ended yet)
+            uint16_t hash;
+        } rxName;
+
+        // returns the bucket for a hash
+        uint16_t Bucket(uint16_t hash) const
+        {
+            return (uint16_t)((hash ^ (hash >> 8)) & bucketMask);
+        }
+};
+
+/**
+ * Hash index storage sized at compile time.
+ *
+ * \tparam MaxCmds: the maximum number of commands (table entries) that can be indexed
+ * \tparam Buckets: the number of hash buckets (a power of 2, default is >= MaxCmds)
+ *
+ * The index is in RAM: 2 bytes per bucket plus 2 bytes per command, 2 * (Buckets + MaxCmds)
+ * bytes. (That is a large part of the 2K bytes of RAM on an ATmega328 for a big command table -
+ * fewer buckets than commands use less RAM for a few more name compares per lookup.)
+ *
+ * Example: (a table of up to 160 commands using 2 * (256 + 160) = 832 bytes of RAM)
+ *
+ *     CmdLineHashIndexN<160> CmdIndex;
+ *     CmdLine.SetHashIndex(CmdIndex);
+ *
+ * Example: (the same table with 64 buckets, 2 * (64 + 160) = 448 bytes of RAM, and an average
+ * of 2.5 commands per bucket)
+ *
+ *     CmdLineHashIndexN<160, 64> CmdIndex;
+ */
+template <uint16_t MaxCmds, uint16_t Buckets = CmdLinePow2(MaxCmds)>
+class CmdLineHashIndexN : public CmdLineHashIndex
+{
+    static_assert((Buckets & (Buckets - 1)) == 0, "Buckets must be a power of 2");
+
+    public:
+        CmdLineHashIndexN() : CmdLineHashIndex(headStore, Buckets, linkStore, MaxCmds) {}
+
+    private:
+        uint16_t headStore[Buckets];
+        uint16_t linkStore[MaxCmds];
+};
+
+#if CMDLINE_COUNTERS
+/**
+ *  Defines the name of the built-in command that shows the receive path counters
+ *  ("counters" shows them, "counters clear" clears them).
+ */
+#define CMDLINE_COUNTERS_CMD    "counters"
+
+/**
+ * Structure for the receive path counters of a command line (see \ref CommandLineBase::Counters()).
+ */
+typedef struct
+{
+    /// The number of received bytes processed (the type-ahead dropped before a break character is not counted).
+    uint32_t bytesIn;
+
+    /// The number of received characters echoed.
+    uint32_t bytesEchoed;
+
+    /// The number of command lines (or frames) dispatched.
+    uint32_t lines;
+
+    /// The number of command lines (or frames) that were too long for the command line buffer.
+    uint32_t overflows;
 
+    /// The number of backspaces received.
+    uint32_t backspaces;
+
+    /// The number of \ref CMDLINE_BAD_CMD results (unknown commands).
+    uint32_t badCmds;
+
+    /// The length of the longest command line (or frame) received.
+    uint16_t maxLineLen;
+} tCmdLineCounters;
+#endif // CMDLINE_COUNTERS
+
+#if CMDLINE_STATS
+/**
+ *  Defines the number of execution time histogram buckets of a command (log 4 microseconds:
+ *  < 4, < 16, < 64, < 256, < 1024, < 4096, < 16384, >= 16384 us).
+ */
+#define CMDLINE_STATS_BUCKETS   8
+
+/**
+ *  Defines the name of the built-in command that shows the command statistics
+ *  ("stats" shows them, "stats clear" clears them).
+ */
+#define CMDLINE_STATS_CMD       "stats"
+
+/**
+ * Structure for the execution time statistics of a command (in RAM).
+ */
+typedef struct
+{
+    /// The number of times the command function was called.
+    uint32_t count;
+
+    /// The minimum, maximum and total execution times in microseconds.
+    uint32_t minMicros;
+    uint32_t maxMicros;
+    uint32_t totalMicros;
+
+    /// The execution time histogram (see \ref CMDLINE_STATS_BUCKETS, counts stop at 0xffff).
+    uint16_t hist[CMDLINE_STATS_BUCKETS];
+} tCmdLineStat;
+
+/**
+ * Per-command execution time statistics of a command table (see \ref CommandLineBase::SetStats()).
+ *
+ * The statistics storage (one \ref tCmdLineStat per command, in the same order as the
+ * command table) is declared (and sized) at compile time with \ref CmdLineStatsN.
+ */
+class CmdLineStats
+{
+    public:
         /**
-         * Sets the parameter separator character(s) to use (if other than the default '\\r').
+         *  A constructor that sets up the statistics storage.
          *
-         * \param terminators: the command line terminator character(s) to use (2 maximum supported)
+         *  \param entries: array of command statistics (one per command)
+         *  \param maxCmds: number of entries in \e entries (commands after these are not timed)
          */
-        void Terminators(char * terminators);
+        CmdLineStats(tCmdLineStat * entries, uint16_t maxCmds);
 
         /**
-         * Sets the custom handler function to use for unknown commands
-         * (i.e. commands not in command table) (default is none).
-         *
-         * \param function: the handler function for unknown commands
+         * Clears the statistics of all of the commands.
          */
-        void SetDefaultHandler(pfnCmdLine function);
+        void Clear(void);
 
         /**
-         * Sets the custom handler function to use for commands errors (default is internal).
+         * Records an execution time of a command.
          *
-         * \param function: the custom handler function for commands errors
+         * \param cmd: the index of the command in the command table
+         * \param us: the execution time in microseconds
          */
-        void SetCustomErrorHandler(pfnCustomErrs function);
+        void Record(uint16_t cmd, uint32_t us);
 
         /**
-         * Shows the menu commands.
+         * Returns the statistics of a command (NULL if the command is not timed).
          *
-         * \param help_info_disable: optional flag to disable (if \e true) showing help information
-         *                           (default = false)
+         * \param cmd: the index of the command in the command table
          */
-        void ShowCommands(bool help_info_disable = false);
+        const tCmdLineStat * Entry(uint16_t cmd) const
+        {
+            return (cmd < maxCmds) ? &entries[cmd] : NULL;
+        }
 
         /**
-         * Flush the serial receive buffer.
+         * Returns the histogram bucket for an execution time.
+         *
+         * \param us: the execution time in microseconds
          */
-        void FlushReceive(void)
-        {
-            input.index = 0;
-            input.g_cCmdBuf[0] = '\0';
-        }
+        static uint8_t Bucket(uint32_t us);
 
     private:
-        // the I/O stream for the command line characters
-        Stream& serial;
-
-        // the buffer that holds the command line (and some input control variables)
-        struct
-        {
-            bool echoEnable;
-            bool crLfechoEnable;
-            bool crLfcmdEnable;
-            uint8_t index;
-            char g_cCmdBuf[CMD_BUF_SIZE];
-        } input;
-
-        // pointers to command line parameters
-        char * argv[CMDLINE_MAX_ARGS];
+        tCmdLineStat * entries;
+        uint16_t maxCmds;
+};
 
-        // container for command line parameter separator
-        char delimiter;
+/**
+ * Command statistics storage sized at compile time.
+ *
+ * \tparam MaxCmds: the maximum number of commands (table entries) that are timed
+ *
+ * Example: (a table of up to 20 commands using 20 * 32 bytes of RAM)
+ *
+ *     CmdLineStatsN<20> CmdStats;
+ *     CmdLine.SetStats(CmdStats);
+ */
+template <uint16_t MaxCmds>
+class CmdLineStatsN : public CmdLineStats
+{
+    public:
+        CmdLineStatsN() : CmdLineStats(store, MaxCmds) {}
 
-        // container for command line terminator(s)
-        char terminators[CMDLINE_MAX_TERMINATORS + 1];
+    private:
+        tCmdLineStat store[MaxCmds];
+};
+#endif // CMDLINE_STATS
 
-        // pointer to unknown command handler
-        pfnCmdLine defaultFunc;
+class CmdLineQueue;
+class CmdLineOutput;
+class CmdLineTee;
+class CmdLineRxRing;
 
-        // pointer to unknown command handler
+/**
+ * CommandLine Arduino library class. Version: "V1.11 10/16/2026"
+ *
+ * This is the command line processing code, which works on the command line buffers of a
+ * \ref CommandLineN (its sizes are set at compile time, \ref CommandLine is the default).
+ */
+class CommandLineBase
+{
+    public:
+        /// Defines the value that is returned if the command is not found.
+        #define CMDLINE_BAD_CMD         (-1)
+
+        /// Defines the value that is returned if there are too many arguments.
+        #define CMDLINE_TOO_MANY_ARGS   (-2)
+
+        /// Defines the value that is returned if there are not enough arguments.
+        #define CMDLINE_TOO_FEW_ARGS    (-3)
+
+        /// Defines the value that is returned if an argument is invalid.
+        #define CMDLINE_INVALID_ARG     (-4)
+
+        /// Defines the value that is returned if a binary frame is bad (CRC error or bad arguments).
+        #define CMDLINE_BAD_FRAME       (-5)
+
+        /// Defines the value that is reported if a command in progress is aborted (by the break character).
+        #define CMDLINE_ABORTED         (-6)
+
+        /// Defines the value that a command function returns if it is not done (it is called again).
+        #define CMDLINE_PENDING         (-128)
+
+        /**
+         * Defines the maximum LEN of a binary frame (the command id and args bytes) of a
+         * \ref CommandLine. (the command line buffer also holds the LEN byte, the last argument's
+         * terminator and the command name terminator, and LEN is at most 255)
+         */
+        #define CMDLINE_FRAME_MAX_LEN   (CMD_BUF_SIZE - 3)
+
+        /**
+         * Implements the non-blocking serial command processing.
+         *
+         * \return   int8_t
+         * \return   0 = no command to process yet
+         * \return   1 = a command was processed
+         *
+         *  \note This should be called in \e 'loop()' to check for/process incoming commands.
+         */
+        int8_t DoCmdLine(void);
+
+        /**
+         * Implements the non-blocking serial command processing, processing no more than
+         * \e maxChars received characters (any further characters are processed by the next call).
+         *
+         * \param maxChars: the maximum number of received characters to process
+         *                  (\ref CMDLINE_NO_LIMIT = no limit)
+         *
+         * \return   int8_t
+         * \return   0 = no command to process yet
+         * \return   1 = a command was processed
+         */
+        int8_t DoCmdLine(uint16_t maxChars);
+
+        /**
+         * Implements the non-blocking serial command processing, doing no more than \e maxChars
+         * received characters and \e maxMicros microseconds of work per call.
+         *
+         * The work is done in steps (receiving a chunk of characters, executing a command,
+         * reporting a command error) and the budget is checked after each step. Work left
+         * when the budget runs out is resumed by the next call, so the worst case time of a
+         * call is bounded by the budget plus one step.
+         *
+         * \param maxChars: the maximum number of received characters to process
+         *                  (\ref CMDLINE_NO_LIMIT = no limit)
+         * \param maxMicros: the time budget for the call in microseconds
+         *                   (\ref CMDLINE_NO_TIME_LIMIT = no time limit)
+         *
+         * \return   int8_t
+         * \return   0 = no command to process yet
+         * \return   1 = a command was processed
+         *
+         *  \note The time taken by a command function itself can not be limited.
+         */
+        int8_t DoCmdLine(uint16_t maxChars, uint32_t maxMicros);
+
+        /**
+         * Processes a chunk of received characters handed over by the caller (a BLE
+         * notification, a TCP or USB packet handler) - the push counterpart of polling
+         * the stream with \ref DoCmdLine().
+         *
+         * The characters go through the same command line (or frame) assembly and echo, and
+         * each complete command line is executed, in one pass over the chunk.
+         *
+         * \param data: the received characters
+         * \param len: the number of characters
+         *
+         * \return   size_t = the number of characters taken - less than \e len if a command
+         *           (see \ref CmdState()) or a command listing (see \ref ShowCommandsAsync()) is
+         *           in progress: feed the rest again after \ref DoCmdLine() has finished it
+         *
+         *  \note \ref DoCmdLine() must still be called for a command or listing in progress
+         *  and for an output queue. The line queue (see \ref SetLineQueue()) is not used.
+         */
+        size_t Feed(const uint8_t * data, size_t len);
+
+        /**
+         * Support routine that parses a command parameter string into a decimal or hex
+         * numeric value or identifies it as a quoted string.
+         *
+         * \param param: parameter string to parse
+         * \param retval: place for parsed numeric value (if type DECVAL or HEXVAL)
+         *
+         * \return   type of parameter
+         * \return   - DECVAL   = decimal numeric parameter value (1234) - value returned at *retval
+         * \return   - HEXVAL   = hex numeric parameter value (0x12ab) - value returned at *retval
+         * \return   - STRVAL   = string parameter value ("quoted string")
+         * \return   - BADPARAM = bad parameter (or out of range value, *retval is not changed)
+         *
+         *  \note Hex values are returned as their bit pattern (0xffffffff = -1).
+         *
+         *  \note The command line processor (\b CmdLineProcess()) does *not* keep the contents
+         *  of a quoted string intact. Each word in the string (a space is considered a
+         *  word delimiter - TABs are not) is placed in a separate argument! (The argument
+         *  with the first word in the quoted string contains the opening quote and the
+         *  argument with the last word in the quoted string contains the closing quote.)
+         */
+        int8_t ParseParam(char * param, int32_t * retval);
+
+        /**
+         * Parses a command parameter string into an unsigned decimal or hex numeric value
+         * or identifies it as a quoted string (see \ref ParseParam(char *, int32_t *)).
+         *
+         * \param param: parameter string to parse
+         * \param retval: place for parsed numeric value (if type DECVAL or HEXVAL)
+         *
+         * \return   type of parameter (DECVAL, HEXVAL, STRVAL or BADPARAM)
+         *
+         *  \note A negative value is a bad parameter.
+         */
+        int8_t ParseParam(char * param, uint32_t * retval);
+
+        /**
+         * Parses a command parameter string into a 64-bit decimal or hex numeric value
+         * or identifies it as a quoted string (see \ref ParseParam(char *, int32_t *)).
+         *
+         * \param param: parameter string to parse
+         * \param retval: place for parsed numeric value (if type DECVAL or HEXVAL)
+         *
+         * \return   type of parameter (DECVAL, HEXVAL, STRVAL or BADPARAM)
+         */
+        int8_t ParseParam(char * param, int64_t * retval);
+
+        /**
+         * Returns the converted value of an argument of the command being executed
+         * (for a command that has an argument schema, see \ref tCmdLineArgs).
+         *
+         * \param arg: the argument number (ARG1 ... ARG9, or up to the MaxArgs of a \ref CommandLineN)
+         *
+         * \return   int32_t
+         * \return   - the numeric value of a CMDLINE_ARG_INT or CMDLINE_ARG_HEX argument
+         * \return   - the keyword index of a CMDLINE_ARG_KEYWORD argument
+         * \return   - 0 for a CMDLINE_ARG_STR argument or an argument that was not given
+         *
+         *  \note Only valid while the command function is running (on each call of a
+         *  command that returns \ref CMDLINE_PENDING).
+         */
+        int32_t ArgValue(uint8_t arg);
+
+        /**
+         * Returns \e true if a numeric argument of the command being executed was given
+         * in hex (for a command that has an argument schema, see \ref tCmdLineArgs).
+         *
+         * \param arg: the argument number (ARG1 ... ARG9, or up to the MaxArgs of a \ref CommandLineN)
+         *
+         * \return   \e true = a CMDLINE_ARG_INT or CMDLINE_ARG_HEX argument given in hex
+         *           ("0x1f"), \e false = any other argument (or one that was not given)
+         *
+         *  \note Only valid while the command function is running.
+         */
+        bool ArgIsHex(uint8_t arg);
+
+        /**
+         * Returns the state slot of the command being executed - for a command function that
+         * returns \ref CMDLINE_PENDING to keep its place between calls.
+         *
+         * The slot is 0 on the first call of each command. While the command is in progress,
+         * its command line stays in the command line buffer (\e argv[] stays valid) and no
+         * further command lines are received, but the break character (see \ref BreakChar())
+         * aborts the command (\ref CMDLINE_ABORTED is reported).
+         *
+         * \return   uint32_t& = the state slot
+         *
+         *  \note A command batch (see \ref BatchSeparator()) goes on after the command is done.
+         */
+        uint32_t& CmdState(void)
+        {
+            return pending.state;
+        }
+
+        /**
+         * Returns \e true if the command in progress is being aborted - the command function
+         * is called once more to clean up (its return value is ignored).
+         */
+        bool CmdAborted(void) const
+        {
+            return work.aborted;
+        }
+
+        /**
+         * Enables/disables echo of incoming characters (default is enabled).
+         *
+         * \param echoEnable: a flag that is used to enable/disable echo of incoming characters
+         *                    (\e true = enable echo, \e false = disable echo)
+         *
+         *  \note CR/LF will not be echoed if \ref Echo() is enabled and \ref CrLfEcho() is disabled.
+         */
+        void Echo(bool echoEnable);
+
+        /**
+         * Enables/disables echo of incoming CR/LF characters (default is disabled).
+         *
+         * \param crLfechoEnable: a flag that is used to enable/disable echo of incoming CR/LF characters
+         *                        (\e true = enable echo, \e false = disable echo)
+         *
+         *  \note This has no effect if \ref Echo() is disabled.
+         */
+        void CrLfEcho(bool crLfechoEnable);
+
+        /**
+         * Enables/disables sending CR/LF characters before processing command (default is enabled).
+         *
+         * \param crLfcmdEnable: a flag that is used to enable/disable sending CR/LF characters
+         *                       before processing a command
+         *                       (\e true = enable CR/LF response, \e false = disable CR/LF response)
+         */
+        void CrLfCommand(bool crLfcmdEnable);
+
+        /**
+         * Sets the parameter separator character to use (if other than the default space ' ').
+         *
+         * \param delimiter: the delimiter (or parameter separator) character
+         */
+        void Delimiter(char delimiter);
+
+        /**
+         * Sets the parameter separator character(s) to use (if other than the default '\\r').
+         *
+         * \param terminators: the command line terminator character(s) to use (\ref CMDLINE_MAX_TERMINATORS
+         *                     maximum supported, or the MaxTerminators of a \ref CommandLineN)
+         */
+        void Terminators(char * terminators);
+
+        /**
+         * Sets the separator character for a batch of commands in one command line
+         * (default is \ref CMDLINE_NO_BATCH, no command batches).
+         *
+         * The commands of a batch ("cmd1 a; cmd2 b; cmd3") are executed in order, and the
+         * status of each command is reported (to the custom error handler, if one is set).
+         *
+         * \param separator: the command separator character (e.g. ';'), \ref CMDLINE_NO_BATCH = none
+         * \param stopOnError: a flag that the rest of a batch is skipped after a command
+         *                     returns an error (\e true = stop on error (default), \e false =
+         *                     continue on error)
+         *
+         *  \note A batch is one unit of work for the DoCmdLine() time budget.
+         */
+        void BatchSeparator(char separator, bool stopOnError = true);
+
+        /**
+         * Sets the break character (default is Ctrl-C, \ref CHAR_CTRL_C).
+         *
+         * The break character cancels the work in progress: the queued output (see \ref SetOutput())
+         * is discarded, a command listing (see \ref ShowCommandsAsync()) is stopped, a command in
+         * progress (see \ref CmdState()) is aborted, and the command line being received (and
+         * any queued command lines) are discarded.
+         *
+         * \param breakChar: the break character, \ref CMDLINE_NO_BREAK = none
+         *
+         *  \note Only in the text console (the framing modes are 8-bit clean).
+         */
+        void BreakChar(char breakChar);
+
+        /**
+         * Sets the custom handler function to use for unknown commands
+         * (i.e. commands not in command table) (default is none).
+         *
+         * \param function: the handler function for unknown commands
+         */
+        void SetDefaultHandler(pfnCmdLine function);
+
+        /**
+         * Sets the custom handler function to use for commands errors (default is internal).
+         *
+         * \param function: the custom handler function for commands errors
+         */
+        void SetCustomErrorHandler(pfnCustomErrs function);
+
+        /**
+         * Sets an output queue for the command line output (default is none, the output
+         * is written to the stream, which blocks while its transmit buffer is full).
+         *
+         * With an output queue, the output (echo, error messages, \ref ShowCommands() and
+         * anything printed to \ref Output()) is written to the stream only as far as its
+         * \e availableForWrite() allows, and the rest is written by the following
+         * \ref DoCmdLine() calls.
+         *
+         * \param queue: the output queue (see \ref CmdLineOutputN)
+         */
+        void SetOutput(CmdLineOutput& queue);
+
+        /**
+         * Sets where the command line output is written (default is the stream).
+         *
+         * \param out: the output (e.g. a BLE, TCP or USB connection's Print)
+         *
+         *  \note With an output queue (see \ref SetOutput(CmdLineOutput&)), the queued output
+         *  is written to \e out.
+         */
+        void SetOutput(Print& out);
+
+        /**
+         * Sets a receive ring to get the received characters from (default is none, they are
+         * read from the stream).
+         *
+         * The ring is fed by an interrupt handler (a UART receive interrupt, a DMA callback, see
+         * \ref CmdLineRxRing::Put()), so no characters are lost while \ref DoCmdLine() is not
+         * being called (as long as the ring has room).
+         *
+         * \param ring: the receive ring (see \ref CmdLineRxRingN)
+         *
+         *  \note The stream is still used for the output, but it is not read from again.
+         */
+        void SetRxRing(CmdLineRxRing& ring);
+
+        /**
+         * Returns where the command line output goes (the output queue, if one is set,
+         * otherwise the stream or the output set by \ref SetOutput(Print&)) - for command
+         * functions to print their output in order with the command line output.
+         */
+        Print& Output(void)
+        {
+            return *output;
+        }
+
+        /**
+         * Sets a queue for received command lines (default is none, one command line
+         * is received and executed per \ref DoCmdLine() call).
+         *
+         * With a queue, each \ref DoCmdLine() call first receives all of the available
+         * characters (pipelined command lines are queued while there is room), then
+         * executes all of the queued command lines.
+         *
+         * \param queue: the queue (see \ref CmdLineQueueN)
+         *
+         * \return   \e true = queue in use, \e false = the queue lines are too short
+         */
+        bool SetLineQueue(CmdLineQueue& queue);
+
+        /**
+         * Sets the command table for this command line (default is \e g_sCmdTable).
+         *
+         * \param table: the command table (in Flash)
+         * \param numCmds: the number of entries in \e table (or \ref CMDLINE_TABLE_UNSIZED if
+         *                 the end of the table is marked by a null command entry)
+         *
+         *  \note A hash index in use (see \ref SetHashIndex()) is rebuilt for the new table.
+         */
+        void SetCommandTable(const tCmdLineEntry * table, uint16_t numCmds = CMDLINE_TABLE_UNSIZED);
+
+        /**
+         * Sets the command table for this command line (the number of table entries
+         * is known at compile time).
+         *
+         * \param table: the command table (array in Flash)
+         */
+        template <size_t N>
+        void SetCommandTable(const tCmdLineEntry (&table)[N])
+        {
+            SetCommandTable(table, N);
+        }
+
+        /**
+         * Sets a hash index to use for command lookup (default is none, a linear
+         * search of the command table).
+         *
+         * \param index: the hash index (see \ref CmdLineHashIndexN) - it is built for
+         *               the command table by this call
+         *
+         * \return   \e true = index in use, \e false = the command table does not fit
+         *           the index (the linear search is used)
+         */
+        bool SetHashIndex(CmdLineHashIndex& index);
+
+#if CMDLINE_STATS
+        /**
+         * Sets the per-command execution time statistics to keep (default is none).
+         *
+         * With statistics, each command function call is timed, and the built-in
+         * \ref CMDLINE_STATS_CMD command (if not in the command table) shows them.
+         *
+         * \param stats: the statistics (see \ref CmdLineStatsN) - they are cleared by this call
+         */
+        void SetStats(CmdLineStats& stats);
+
+        /**
+         * Shows the per-command execution time statistics (of the commands that were called).
+         */
+        void ShowStats(void);
+#endif
+
+#if CMDLINE_COUNTERS
+        /**
+         * Returns the receive path counters (since the start or the last \ref ClearCounters()).
+         */
+        const tCmdLineCounters& Counters(void) const
+        {
+            return counters;
+        }
+
+        /**
+         * Clears the receive path counters.
+         */
+        void ClearCounters(void);
+
+        /**
+         * Shows the receive path counters (also done by the built-in \ref CMDLINE_COUNTERS_CMD command,
+         * if it is not in the command table).
+         */
+        void ShowCounters(void);
+#endif
+
+        /**
+         * Shows the menu commands.
+         *
+         * \param help_info_disable: optional flag to disable (if \e true) showing help information
+         *                           (default = false)
+         */
+        void ShowCommands(bool help_info_disable = false);
+
+        /**
+         * Shows the menu commands a few at a time (a resumable \ref ShowCommands()).
+         *
+         * The listing is written by the following \ref DoCmdLine() calls: one command per call,
+         * or with an output queue (see \ref SetOutput()), as many commands as the queue has
+         * room for. Command lines received during the listing are executed after it.
+         *
+         * \param help_info_disable: optional flag to disable (if \e true) showing help information
+         *                           (default = false)
+         *
+         *  \note Typically called from a "help" command function. The command is processed
+         *  (\ref DoCmdLine() returns 1) when the listing is done.
+         */
+        void ShowCommandsAsync(bool help_info_disable = false);
+
+        /**
+         * Sets the framing mode of the command line (default is the text console).
+         *
+         * In the binary framing mode, commands are received as length-prefixed binary
+         * frames (see \ref CMDLINE_FRAME_SYNC) and dispatched into the same command table
+         * functions, without echo or text error messages: each frame is answered with
+         * a status frame. A frame with the \ref CMDLINE_FRAME_EXIT command id returns
+         * to the text console.
+         *
+         * In the SLIP and COBS framing modes, each frame carries an 8-bit clean command
+         * line (no terminators, echo or high bit stripping) of any bytes but 0x00. Frames
+         * are decoded into the command line buffer as they are received and processed as a
+         * command line. The receiver resynchronizes on the next frame delimiter after a bad
+         * (too long, badly encoded, or with a 0x00 in its command line) frame, which is dropped.
+         *
+         * \param mode: the framing mode (\ref CMDLINE_FRAME_TEXT, \ref CMDLINE_FRAME_BINARY,
+         *              \ref CMDLINE_FRAME_SLIP or \ref CMDLINE_FRAME_COBS)
+         *
+         *  \note Typically called from a text console command. A binary frame with a bad
+         *  LEN is dropped without an answer.
+         *
+         *  \note The command name (\e argv[0]) of a binary frame is the command table string
+         *  (it must not be changed). On AVR and ESP8266 it is copied after the frame in the
+         *  command line buffer instead, so a frame whose LEN plus command name length is over
+         *  (\ref CMD_BUF_SIZE - 3) is answered with \ref CMDLINE_BAD_FRAME.
+         */
+        void FrameMode(uint8_t mode);
+
+        /**
+         * Flush the serial receive buffer.
+         */
+        void FlushReceive(void)
+        {
+            NewLine();
+            CmdBuf()[0] = '\0';
+        }
+
+    protected:
+        /**
+         *  A constructor that sets up the command line processing code on its command line buffers
+         *  (see \ref CommandLineN).
+         *
+         *  \param serial: the stream that a command line is implemented on (typically 'Serial'),
+         *                 NULL = none (the input is fed with \ref Feed())
+         *  \param out: where the command line output is written
+         *  \param buffers: the command line buffers (laid out as a \ref CmdLineBuffers, which
+         *                  starts with its \e argv array)
+         *  \param bufSize: the size of the command line buffer
+         *  \param maxArgs: the maximum number of arguments that can be parsed
+         *  \param maxTerminators: the maximum number of command line terminators
+         *
+         *  \return None.
+         *
+         *  \note Defaults to enable echo of incoming characters.
+         */
+        CommandLineBase(Stream * serial, Print& out, char ** buffers, uint16_t bufSize, uint8_t maxArgs,
+                        uint8_t maxTerminators);
+
+    private:
+        // where the received characters come from: the input stream (NULL = none, see Feed()),
+        // or the receive ring when input.fromRing is set (see SetRxRing())
+        union
+        {
+            Stream * serial;
+            CmdLineRxRing * rxRing;
+        } source;
+
+        // where the command line output goes (the output stream, or the output queue when
+        // input.outQueued is set)
+        Print * output;
+
+        // pointers to command line parameters (the start of the command line buffers, see
+        // CmdLineBuffers - the other buffers are found from it and the sizes)
+        char ** argv;
+
+        // the buffer that holds the command line (and some input control variables)
+        struct
+        {
+            uint16_t index;
+            uint16_t bufSize;
+            bool echoEnable : 1;
+            bool crLfechoEnable : 1;
+            bool crLfcmdEnable : 1;
+            bool outQueued : 1;     // the output is the output queue (see SetOutput())
+            bool fromRing : 1;      // the received characters come from the receive ring
+            char breakChar;
+        } input;
+
+        // the chunk of received characters being processed (and the start of
+        // the received characters that have not been echoed yet)
+        struct
+        {
+            uint8_t pos;
+            uint8_t len;
+            uint8_t echo;
+            uint8_t buf[CMDLINE_RX_CHUNK];
+        } rx;
+
+        // the command line work left for the next DoCmdLine() call
+        struct
+        {
+            bool lineReady : 1;     // a received command line is waiting to be executed
+            bool crLf : 1;          // the waiting command line was ended by CR/LF
+            bool statusPending : 1; // an executed command's status is waiting to be reported
+            bool timed : 1;         // the DoCmdLine() call has a time budget
+            bool showing : 1;       // a command listing is in progress (see ShowCommandsAsync())
+            bool showNoHelp : 1;    // the listing in progress leaves out the help
+            bool pending : 1;       // a command is in progress (see CmdState())
+            bool aborted : 1;       // the command in progress is called to clean up (see CmdAborted())
+            int8_t status;
+        } work;
+
+        // the next command table entry of the listing in progress (see ShowCommandsAsync())
+        uint16_t showNext;
+
+        // the end of the time budget of the DoCmdLine() call
+        uint32_t budgetEnd;
+
+        // the command in progress (that returned CMDLINE_PENDING)
+        struct
+        {
+            uint32_t state;         // the command's state slot (see CmdState())
+            uint16_t entry;         // its command table entry (PENDING_DEFAULT = the default handler)
+            uint16_t rest;          // the offset of the rest of its command batch in its command line
+                                    // (0 = none)
+            int8_t argc;
+            bool queued;            // its command line is in the line queue
+        } pending;
+
+        // the framing mode (and binary frame state)
+        struct
+        {
+            uint8_t mode;
+            uint8_t state;          // frame receive state
+            uint8_t crc;            // binary frame CRC-8 being received
+            uint8_t code;           // COBS code of the block being received
+            uint8_t left;           // COBS bytes left in the block being received
+            uint8_t id;             // command id of the executed binary frame
+            bool reply;             // the command status is answered with a status frame
+        } frame;
+
+        // the sizes of the argv[] and command line terminators buffers
+        uint8_t maxArgs;
+        uint8_t maxTerminators;
+
+        // the converted argument values (and hex flags) are for the command being executed
+        bool argsValid;
+
+        // container for command line parameter separator
+        char delimiter;
+
+        // command batch separator (and error handling)
+        struct
+        {
+            char separator;
+            bool stopOnError;
+        } batch;
+
+        // the number of arguments of the command line being received put in argv[] (the command
+        // line is split into arguments as it is received, CMDLINE_RX_UNSPLIT = it is not)
+        uint8_t rxArgs;
+
+        // the number of entries of the command table
+        uint16_t numCmds;
+
+        // pointer to unknown command handler
+        pfnCmdLine defaultFunc;
+
+        // pointer to command error handler
         pfnCustomErrs errorFunc;
 
-        // sets the operating defaults.
-        void SetDefaults(bool echoEnable);
+        // the command table
+        const tCmdLineEntry * cmdTable;
+
+        // pointer to command lookup hash index (NULL = linear search)
+        CmdLineHashIndex * hashIndex;
+
+        // pointer to received command line queue (NULL = none)
+        CmdLineQueue * lineQueue;
+
+#if CMDLINE_STATS
+        // pointer to per-command execution time statistics (NULL = none)
+        CmdLineStats * stats;
+#endif
+
+#if CMDLINE_COUNTERS
+        // the receive path counters
+        tCmdLineCounters counters;
+#endif
+
+        // sets the operating defaults.
+        void SetDefaults(bool echoEnable);
+
+        // gets available text from the user until a command line is complete
+        bool RxLine(uint16_t * maxChars, char * last);
+
+        // pulls in the next chunk of received characters
+        bool RxFill(void);
+
+        // reads the available received characters
+        uint8_t RxRead(uint8_t * buf, uint8_t size);
+
+        // adds the next received byte of the chunk to the command line (or frame)
+        bool RxByte(char * last);
+
+        // checks the received characters for the break character (while work is in progress)
+        bool RxBreak(void);
+
+        // cancels the work in progress (the break character was received)
+        void Cancel(void);
+
+        // adds a received character to the command line
+        bool RxChar(char ch);
+
+        /// Defines the received argument count for a command line that is not split as it is received.
+        #define CMDLINE_RX_UNSPLIT      0xff
+
+        // starts a new command line in the command line buffer (it is split into arguments as it
+        // is received if it is executed straight from the command line buffer, see RxArg())
+        void NewLine(void)
+        {
+            input.index = 0;
+            rxArgs = ((frame.mode == CMDLINE_FRAME_TEXT) && (lineQueue == NULL) &&
+                      (batch.separator == CMDLINE_NO_BATCH)) ? 0 : CMDLINE_RX_UNSPLIT;
+            if (hashIndex != NULL)
+            {
+                hashIndex->NameStart();
+            }
+        }
+
+        // adds (removes) a received character to (from) the arguments in argv[]
+        char RxArg(char ch);
+        void RxUnarg(char ch);
+
+        // stops splitting the command line being received into arguments
+        void RxArgsOff(void);
+
+        // adds a received character to the hash of the command name (with a hash index)
+        void RxName(char ch)
+        {
+            if (hashIndex != NULL)
+            {
+                hashIndex->NameAdd(input.index, ch, ((ch == delimiter) || (ch == batch.separator)));
+            }
+        }
+
+        // adds a received byte to the binary frame
+        bool RxFrame(uint8_t ch);
+
+        // adds a received byte to the SLIP or COBS frame
+        bool RxSlip(uint8_t ch);
+        bool RxCobs(uint8_t ch);
+
+        // adds a decoded SLIP or COBS frame byte to the command line
+        void RxFramedChar(uint8_t ch);
+
+        // decodes and executes a binary frame
+        int8_t ExecFrame(uint8_t * pFrame);
+
+        // writes a binary status frame
+        void SendFrame(uint8_t id, int8_t nStatus);
+
+        // executes a command line and reports any command error
+        void ExecLine(char * pcLine, bool crLf);
+
+        // reports a command error (or leaves it for the next DoCmdLine() call)
+        void EndLine(int8_t nStatus);
+
+        // calls the command in progress again
+        bool ResumeCmd(void);
+
+        // executes the queued command lines
+        bool ExecQueue(int8_t * processed);
+
+        // reports a command error
+        void ReportStatus(int8_t nStatus);
+
+        // returns the converted argument values of the command being executed (after argv[])
+        int32_t * ArgVals(void) const
+        {
+            return (int32_t *)(argv + maxArgs);
+        }
+
+        // returns the buffer that holds the command line (after the argument values)
+        char * CmdBuf(void) const
+        {
+            return (char *)(ArgVals() + maxArgs);
+        }
+
+        // returns the command line terminator(s) (after the command line buffer)
+        char * TermChars(void) const
+        {
+            return CmdBuf() + input.bufSize;
+        }
+
+        // returns the flags of the arguments given in hex (bit n = argument n, after the terminators)
+        uint8_t * ArgHexFlags(void) const
+        {
+            return (uint8_t *)TermChars() + maxTerminators + 1;
+        }
+
+        // shows a command table entry
+        void ShowEntry(const tCmdLineEntry * pEntry, PGM_P pcCmd, bool help_info_disable);
+
+        // shows the next commands of the listing in progress
+        bool ShowNext(void);
+
+        // returns true if a character is a command line terminator
+        // (the terminators buffer always has room for 2 characters)
+        bool IsTerminator(char ch) const
+        {
+            const char * terminators = TermChars();
+
+            if ((ch == terminators[0]) || (ch == terminators[1]))
+            {
+                return true;
+            }
+            if (terminators[1] != '\0')
+            {
+                for (const char * pc = &terminators[2]; *pc != '\0'; ++pc)
+                {
+                    if (*pc == ch)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // returns the maximum LEN of a binary frame (see CMDLINE_FRAME_MAX_LEN)
+        uint8_t FrameMaxLen(void) const
+        {
+            return (uint8_t)(((input.bufSize - 3) > 0xff) ? 0xff : (input.bufSize - 3));
+        }
+
+        // returns true if the time budget of the DoCmdLine() call has run out
+        bool OutOfTime(void)
+        {
+            return (work.timed && ((int32_t)(micros() - budgetEnd) >= 0));
+        }
+
+        // writes the echo of the received characters up to the one being processed
+        // (in the text console, they are echoed from the receive chunk)
+        void EchoFlush(void)
+        {
+            if (rx.pos > rx.echo)
+            {
+                if (input.echoEnable && (frame.mode == CMDLINE_FRAME_TEXT))
+                {
+#if CMDLINE_COUNTERS
+                    counters.bytesEchoed += (uint8_t)(rx.pos - rx.echo);
+#endif
+                    output->write(&rx.buf[rx.echo], rx.pos - rx.echo);
+                }
+                rx.echo = rx.pos;
+            }
+        }
+
+        // processes a command line string into arguments and executes the command
+        int8_t CmdLineProcess(char * pcCmdLine);
+
+        // executes the commands of a command batch
+        int8_t ExecBatch(char * pcLine, uint16_t start, bool executed, int8_t nStatus);
+
+#if CMDLINE_STATS || CMDLINE_COUNTERS
+        // executes a built-in command (that is not in the command table)
+        bool BuiltinCmd(int8_t argc);
+#endif
+
+        // calls a command function with the parsed arguments
+        int8_t CallCmd(const tCmdLineEntry * pCmdEntry, int8_t argc);
+
+        // calls the command in progress again
+        int8_t RecallCmd(void);
+
+        // calls a command function (or the default handler)
+        int8_t RunCmd(const tCmdLineEntry * pCmdEntry, int8_t argc);
+
+        // finds a command in the command table
+        const tCmdLineEntry * FindCmd(const char * name);
+
+        // checks and converts the command arguments per the command's argument schema
+        int8_t CheckArgs(const tCmdLineArgs * pArgs, int8_t argc);
+};
+
+/**
+ * Command line buffers sized at compile time (the storage of a \ref CommandLineN).
+ *
+ * \ref CommandLineBase finds all of the buffers from the start of \e argvStore and
+ * the sizes (so they must be laid out back to back).
+ */
+template <uint16_t BufSize, uint8_t MaxArgs, uint8_t MaxTerminators>
+struct CmdLineBuffers
+{
+    char * argvStore[MaxArgs];
+    int32_t argValStore[MaxArgs];
+    char cmdBufStore[BufSize];
+    char terminatorStore[MaxTerminators + 1];
+    uint8_t argHexStore[(MaxArgs + 7) / 8];
+};
+
+/**
+ * CommandLine with its command line buffers sized at compile time.
+ *
+ * \tparam BufSize: the size of the buffer that holds the command line (default is \ref CMD_BUF_SIZE)
+ * \tparam MaxArgs: the maximum number of arguments that can be parsed, including the command
+ *                  itself (default is \ref CMDLINE_MAX_ARGS)
+ * \tparam MaxTerminators: the maximum number of command line terminator characters
+ *                         (default is \ref CMDLINE_MAX_TERMINATORS)
+ *
+ * All sizes share the same command line processing code (\ref CommandLineBase, which is
+ * also the type to use for a reference to any command line).
+ *
+ * Example: (a small console and a large machine port)
+ *
+ *     CommandLineN<16, 3> CmdLineTiny(Serial);     // 16 byte command lines, command + 2 parameters
+ *     CommandLineN<512, 32> CmdLineHost(Serial1);  // 512 byte command lines, command + 31 parameters
+ */
+template <uint16_t BufSize = CMD_BUF_SIZE, uint8_t MaxArgs = CMDLINE_MAX_ARGS,
+          uint8_t MaxTerminators = CMDLINE_MAX_TERMINATORS>
+class CommandLineN : private CmdLineBuffers<BufSize, MaxArgs, MaxTerminators>, public CommandLineBase
+{
+    static_assert(BufSize >= 4, "BufSize must be at least 4");
+    static_assert((MaxArgs >= 1) && (MaxArgs <= 127), "MaxArgs must be 1 - 127");
+    static_assert((MaxTerminators >= 1) && (MaxTerminators < 0xff), "MaxTerminators must be 1 - 254");
+
+    typedef CmdLineBuffers<BufSize, MaxArgs, MaxTerminators> Buffers;
+
+    static_assert((offsetof(Buffers, argValStore) == (MaxArgs * sizeof(char *))) &&
+                  (offsetof(Buffers, cmdBufStore) == (MaxArgs * (sizeof(char *) + sizeof(int32_t)))) &&
+                  (offsetof(Buffers, terminatorStore) == (offsetof(Buffers, cmdBufStore) + BufSize)) &&
+                  (offsetof(Buffers, argHexStore) == (offsetof(Buffers, terminatorStore) + MaxTerminators + 1)),
+                  "the command line buffers must be back to back");
+
+    public:
+        // Constructors
+        /**
+         *  A constructor that sets up the command line processing code.
+         *
+         *  \param _serial: the stream that a command line is implemented on (typically 'Serial')
+         *
+         *  \return None.
+         *
+         *  \note Defaults to enable echo of incoming characters.
+         */
+        CommandLineN(Stream& _serial) :
+            Buffers(),
+            CommandLineBase(&_serial, _serial, Buffers::argvStore, BufSize, MaxArgs, MaxTerminators)
+        {
+        }
+
+        /**
+         *  A constructor that sets up the command line processing code.
+         *
+         *  \param _serial: the stream that a command line is implemented on (typically 'Serial')
+         *  \param echoEnable: a flag that is used to enable/disable echo of incoming characters
+         *                    (\e true = enable echo, \e false = disable echo)
+         *
+         *  \return None.
+         */
+        CommandLineN(Stream& _serial, bool echoEnable) : CommandLineN(_serial)
+        {
+            Echo(echoEnable);
+        }
+
+        /**
+         *  A constructor that sets up the command line processing code with its own command table.
+         *
+         *  \param _serial: the stream that a command line is implemented on (typically 'Serial')
+         *  \param table: the command table (in Flash) for this command line
+         *  \param _numCmds: the number of entries in \e table (or \ref CMDLINE_TABLE_UNSIZED if
+         *                   the end of the table is marked by a null command entry)
+         *
+         *  \return None.
+         *
+         *  \note Defaults to enable echo of incoming characters.
+         */
+        CommandLineN(Stream& _serial, const tCmdLineEntry * table, uint16_t _numCmds) : CommandLineN(_serial)
+        {
+            SetCommandTable(table, _numCmds);
+        }
+
+        /**
+         *  A constructor that sets up the command line processing code with its own command table
+         *  (the number of table entries is known at compile time).
+         *
+         *  \param _serial: the stream that a command line is implemented on (typically 'Serial')
+         *  \param table: the command table (array in Flash) for this command line
+         *
+         *  \return None.
+         *
+         *  \note Defaults to enable echo of incoming characters.
+         */
+        template <size_t N>
+        CommandLineN(Stream& _serial, const tCmdLineEntry (&table)[N]) : CommandLineN(_serial, table, N)
+        {
+        }
 
-        // processes a command line string into arguments and executes the command
-        int8_t CmdLineProcess(char * pcCmdLine);
+        /**
+         *  A constructor that sets up the command line processing code with separate input and
+         *  output (e.g. responses to a faster port, or to a \ref CmdLineTee mirroring them to
+         *  several outputs).
+         *
+         *  \param in: the stream that the command line characters are received from
+         *  \param out: where the command line output (echo, error messages, listings) is written
+         *
+         *  \return None.
+         *
+         *  \note Defaults to enable echo of incoming characters.
+         */
+        CommandLineN(Stream& in, Print& out) :
+            Buffers(),
+            CommandLineBase(&in, out, Buffers::argvStore, BufSize, MaxArgs, MaxTerminators)
+        {
+        }
+
+        /**
+         *  A constructor that sets up the command line processing code with separate input and output.
+         *
+         *  \param in: the stream that the command line characters are received from
+         *  \param out: where the command line output is written
+         *  \param echoEnable: a flag that is used to enable/disable echo of incoming characters
+         *                    (\e true = enable echo, \e false = disable echo)
+         *
+         *  \return None.
+         */
+        CommandLineN(Stream& in, Print& out, bool echoEnable) : CommandLineN(in, out)
+        {
+            Echo(echoEnable);
+        }
+
+        /**
+         *  A constructor that sets up the command line processing code without an input stream
+         *  (the received characters are handed over with \ref Feed()).
+         *
+         *  \param out: where the command line output is written
+         *  \param echoEnable: a flag that is used to enable/disable echo of incoming characters
+         *                    (\e true = enable echo, \e false = disable echo)
+         *
+         *  \return None.
+         */
+        CommandLineN(Print& out, bool echoEnable) :
+            Buffers(),
+            CommandLineBase(NULL, out, Buffers::argvStore, BufSize, MaxArgs, MaxTerminators)
+        {
+            Echo(echoEnable);
+        }
+};
+
+/**
+ * CommandLine with the default command line buffer sizes (\ref CMD_BUF_SIZE,
+ * \ref CMDLINE_MAX_ARGS and \ref CMDLINE_MAX_TERMINATORS).
+ */
+typedef CommandLineN<> CommandLine;
+
+/**
+ * Queue of received command lines (see \ref CommandLineBase::SetLineQueue()).
+ *
+ * The queue storage is declared (and sized) at compile time with \ref CmdLineQueueN.
+ */
+class CmdLineQueue
+{
+    public:
+        /**
+         *  A constructor that sets up the queue storage.
+         *
+         *  \param buf: the storage for the command lines (\e lines * \e slotSize bytes)
+         *  \param lines: the number of command lines the queue holds
+         *  \param slotSize: the size of each command line slot (the command line size + 1)
+         */
+        CmdLineQueue(char * _buf, uint8_t _lines, uint16_t _slotSize) :
+            buf(_buf), slotSize(_slotSize), lines(_lines), head(0), count(0)
+        {
+        }
+
+        /// Returns \e true if the queue is full.
+        bool Full(void) const
+        {
+            return (count >= lines);
+        }
+
+        /// Returns the number of command lines in the queue.
+        uint8_t Count(void) const
+        {
+            return count;
+        }
+
+        /// Returns the maximum size of a queued command line (including its terminating null).
+        uint16_t LineSize(void) const
+        {
+            return (uint16_t)(slotSize - 1);
+        }
+
+        /// Removes all of the command lines from the queue.
+        void Clear(void)
+        {
+            head = 0;
+            count = 0;
+        }
+
+        // adds a command line to the end of the queue
+        void Push(const char * pcLine, uint16_t len, bool crLf);
+
+        // returns the command line at the front of the queue (NULL if none)
+        char * Front(bool * crLf);
+
+        // removes the command line at the front of the queue
+        void Pop(void);
+
+    private:
+        // each slot is the CR/LF ended flag followed by the command line
+        char * buf;
+        uint16_t slotSize;
+        uint8_t lines;
+        uint8_t head;
+        uint8_t count;
+};
+
+/**
+ * Queue of received command lines with its storage sized at compile time.
+ *
+ * \tparam Lines: the number of command lines the queue holds
+ * \tparam MaxLine: the maximum size of a command line (default is \ref CMD_BUF_SIZE)
+ *
+ * Example: (up to 4 pipelined commands)
+ *
+ *     CmdLineQueueN<4> CmdQueue;
+ *     CmdLine.SetLineQueue(CmdQueue);
+ */
+template <uint8_t Lines, uint16_t MaxLine = CMD_BUF_SIZE>
+class CmdLineQueueN : public CmdLineQueue
+{
+    public:
+        CmdLineQueueN() : CmdLineQueue(store, Lines, MaxLine + 1) {}
+
+    private:
+        char store[Lines * (MaxLine + 1)];
+};
+
+/**
+ *  Defines of the output queue overflow policies (see \ref CmdLineOutput::Policy()).
+ */
+#define CMDLINE_OUTPUT_DROP     0   ///< output that does not fit in the queue is dropped (default)
+#define CMDLINE_OUTPUT_BLOCK    1   ///< wait for the stream to take the queued output
+
+/**
+ * Non-blocking output queue (see \ref CommandLineBase::SetOutput()).
+ *
+ * Output is written straight to the stream while it has room (see \e availableForWrite()),
+ * the rest is queued and written as the stream has room by \ref Poll() (which each
+ * \ref CommandLineBase::DoCmdLine() call does). When the queue is full, the overflow
+ * policy either drops the output or waits for the stream.
+ *
+ * The queue storage is declared (and sized) at compile time with \ref CmdLineOutputN.
+ *
+ * \note The stream must implement \e availableForWrite() (it is 0 in the Print class).
+ */
+class CmdLineOutput : public Print
+{
+    public:
+        /**
+         *  A constructor that sets up the queue storage.
+         *
+         *  \param buf: the storage for the queued output
+         *  \param size: the size of \e buf
+         */
+        CmdLineOutput(uint8_t * _buf, uint16_t _size) :
+            sink(NULL), buf(_buf), size(_size), head(0), count(0), policy(CMDLINE_OUTPUT_DROP), dropped(0)
+        {
+        }
+
+        /**
+         * Sets the stream the output is written to (done by \ref CommandLineBase::SetOutput()).
+         *
+         * \param _sink: the stream
+         */
+        void Begin(Print& _sink)
+        {
+            sink = &_sink;
+        }
+
+        /// Returns the stream the output is written to.
+        Print& Sink(void) const
+        {
+            return *sink;
+        }
+
+        /**
+         * Sets the overflow policy (default is \ref CMDLINE_OUTPUT_DROP).
+         *
+         * \param _policy: \ref CMDLINE_OUTPUT_DROP or \ref CMDLINE_OUTPUT_BLOCK
+         */
+        void Policy(uint8_t _policy)
+        {
+            policy = _policy;
+        }
+
+        /**
+         * Writes as much of the queued output as the stream has room for.
+         *
+         * \return   \e true = the queue is empty, \e false = output is left in the queue
+         */
+        bool Poll(void);
+
+        /**
+         * Writes all of the queued output (waits for the stream).
+         */
+        void Flush(void);
+
+        /**
+         * Discards the queued output.
+         */
+        void Clear(void)
+        {
+            head = 0;
+            count = 0;
+        }
+
+        /// Returns the number of bytes in the queue.
+        uint16_t Queued(void) const
+        {
+            return count;
+        }
+
+        /// Returns the number of bytes dropped (by the \ref CMDLINE_OUTPUT_DROP policy).
+        uint32_t Dropped(void) const
+        {
+            return dropped;
+        }
+
+        // Print
+        virtual size_t write(uint8_t ch);
+        virtual size_t write(const uint8_t * buffer, size_t len);
+        virtual int availableForWrite(void)
+        {
+            return (int)(size - count);
+        }
+        using Print::write;
+
+    private:
+        Print * sink;
+        uint8_t * buf;
+        uint16_t size;
+        uint16_t head;
+        uint16_t count;
+        uint8_t policy;
+        uint32_t dropped;
+
+        // returns the queue index past the queued output
+        uint16_t Tail(void) const
+        {
+            uint16_t tail = head + count;
+            return (tail >= size) ? (uint16_t)(tail - size) : tail;
+        }
+};
+
+/**
+ * Output queue with its storage sized at compile time.
+ *
+ * \tparam Size: the size of the queue in bytes
+ *
+ * Example: (up to 256 bytes of output waiting for the stream)
+ *
+ *     CmdLineOutputN<256> CmdOutput;
+ *     CmdLine.SetOutput(CmdOutput);
+ */
+template <uint16_t Size>
+class CmdLineOutputN : public CmdLineOutput
+{
+    public:
+        CmdLineOutputN() : CmdLineOutput(store, Size) {}
+
+    private:
+        uint8_t store[Size];
+};
+
+/**
+ * Defines the receive ring index type - a single byte on the 8-bit AVR (so the
+ * indexes are read and written atomically), which limits the ring to 256 bytes.
+ */
+#if defined(__AVR__)
+typedef uint8_t tCmdLineRingIndex;
+#define CMDLINE_RX_RING_MAX     256
+#else
+typedef uint16_t tCmdLineRingIndex;
+#define CMDLINE_RX_RING_MAX     32768
+#endif
+
+/**
+ * Lock-free receive ring (see \ref CommandLineBase::SetRxRing()).
+ *
+ * Received characters are added by an interrupt handler (a UART receive interrupt or a
+ * DMA callback, see \ref Put()) and taken out by \ref CommandLineBase::DoCmdLine(). There
+ * is a single producer and a single consumer: each side only writes its own index, and
+ * the indexes are passed between them with atomic acquire/release loads and stores, so
+ * no locks (or disabled interrupts) are needed.
+ *
+ * The ring storage is declared (and sized) at compile time with \ref CmdLineRxRingN.
+ *
+ * \note The ring holds one byte less than its size.
+ */
+class CmdLineRxRing
+{
+    public:
+        /**
+         *  A constructor that sets up the ring storage.
+         *
+         *  \param buf: the storage for the ring
+         *  \param size: the size of \e buf (a power of 2, up to \ref CMDLINE_RX_RING_MAX)
+         */
+        CmdLineRxRing(uint8_t * _buf, uint16_t _size) :
+            buf(_buf), mask((tCmdLineRingIndex)(_size - 1)), head(0), tail(0), overruns(0)
+        {
+        }
+
+        /**
+         * Adds a received byte (the producer side, safe to call from an interrupt handler).
+         *
+         * \param ch: the received byte
+         *
+         * \return   \e true = added, \e false = the ring is full (the byte is dropped, see \ref Overruns())
+         */
+        bool Put(uint8_t ch)
+        {
+            tCmdLineRingIndex pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+            tCmdLineRingIndex next = (tCmdLineRingIndex)((pos + 1) & mask);
+
+            if (next == __atomic_load_n(&tail, __ATOMIC_ACQUIRE))
+            {
+                ++overruns;
+                return false;
+            }
+            buf[pos] = ch;
+            __atomic_store_n(&head, next, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /**
+         * Adds a block of received bytes (the producer side, safe to call from an interrupt
+         * handler, e.g. a DMA half/complete callback).
+         *
+         * \param data: the received bytes
+         * \param len: the number of bytes
+         *
+         * \return   uint16_t = the number of bytes added (the rest are dropped, see \ref Overruns())
+         */
+        uint16_t Put(const uint8_t * data, uint16_t len);
+
+        /**
+         * Takes out received bytes (the consumer side, done by \ref CommandLineBase::DoCmdLine()).
+         *
+         * \param data: the place for the bytes
+         * \param len: the maximum number of bytes
+         *
+         * \return   uint16_t = the number of bytes taken out
+         */
+        uint16_t Get(uint8_t * data, uint16_t len);
+
+        /// Returns the number of bytes in the ring (the consumer side).
+        uint16_t Available(void) const
+        {
+            return (uint16_t)((__atomic_load_n(&head, __ATOMIC_ACQUIRE) - tail) & mask);
+        }
+
+        /// Discards the bytes in the ring (the consumer side).
+        void Clear(void)
+        {
+            __atomic_store_n(&tail, __atomic_load_n(&head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+        }
+
+        /**
+         * Returns the number of bytes dropped because the ring was full.
+         *
+         *  \note Written by the producer - on an 8-bit target, read it with interrupts disabled.
+         */
+        uint32_t Overruns(void) const
+        {
+            return overruns;
+        }
+
+    private:
+        uint8_t * buf;
+        tCmdLineRingIndex mask;
+        tCmdLineRingIndex head;     // written by the producer
+        tCmdLineRingIndex tail;     // written by the consumer
+        volatile uint32_t overruns;
+};
+
+/**
+ * Receive ring with its storage sized at compile time.
+ *
+ * \tparam Size: the size of the ring in bytes (a power of 2, up to \ref CMDLINE_RX_RING_MAX)
+ *
+ * Example: (a UART receive interrupt feeding the command line)
+ *
+ *     CmdLineRxRingN<128> CmdRxRing;
+ *     CmdLine.SetRxRing(CmdRxRing);
+ *
+ *     ISR(USART0_RX_vect)
+ *     {
+ *         CmdRxRing.Put(UDR0);
+ *     }
+ */
+template <uint16_t Size>
+class CmdLineRxRingN : public CmdLineRxRing
+{
+    static_assert((Size >= 2) && ((Size & (Size - 1)) == 0), "Size must be a power of 2");
+    static_assert(Size <= CMDLINE_RX_RING_MAX, "Size must be at most CMDLINE_RX_RING_MAX");
+
+    public:
+        CmdLineRxRingN() : CmdLineRxRing(store, Size) {}
+
+    private:
+        uint8_t store[Size];
+};
+
+/**
+ * Output mirror - a Print that writes all of its output to several outputs (e.g. the
+ * serial port and a log in RAM), so command functions print once (to
+ * \ref CommandLineBase::Output()) and the output is mirrored.
+ *
+ * Each write is passed on as is (the same buffer, no copy) to every output. The number of
+ * characters written is the first output's.
+ *
+ * The list of outputs is declared (and sized) at compile time with \ref CmdLineTeeN.
+ *
+ * \note With an output queue (see \ref CommandLineBase::SetOutput()), the room for output
+ * (\e availableForWrite()) is the smallest room of the outputs, so each output must implement
+ * \e availableForWrite() (it is 0 in the Print class).
+ */
+class CmdLineTee : public Print
+{
+    public:
+        /**
+         *  A constructor that sets up the list of outputs.
+         *
+         *  \param sinks: the storage for the list of outputs
+         *  \param maxSinks: the number of entries in \e sinks
+         */
+        CmdLineTee(Print ** _sinks, uint8_t _maxSinks) :
+            sinks(_sinks), maxSinks(_maxSinks), count(0)
+        {
+        }
+
+        /**
+         * Adds an output.
+         *
+         * \param sink: the output (the first one added is the primary output)
+         *
+         * \return   \e true = added, \e false = the list of outputs is full
+         */
+        bool Add(Print& sink);
+
+        // Print
+        virtual size_t write(uint8_t ch);
+        virtual size_t write(const uint8_t * buffer, size_t len);
+        virtual int availableForWrite(void);
+        using Print::write;
+
+    private:
+        Print ** sinks;
+        uint8_t maxSinks;
+        uint8_t count;
+};
+
+/**
+ * Output mirror with its list of outputs sized at compile time.
+ *
+ * \tparam MaxSinks: the maximum number of outputs
+ *
+ * Example: (responses to the serial port, mirrored to a log)
+ *
+ *     CmdLineTeeN<2> CmdOut;
+ *     CommandLine CmdLine(Serial, CmdOut);
+ *
+ *     CmdOut.Add(Serial);      // in setup()
+ *     CmdOut.Add(CmdLog);
+ */
+template <uint8_t MaxSinks>
+class CmdLineTeeN : public CmdLineTee
+{
+    static_assert(MaxSinks >= 1, "MaxSinks must be at least 1");
+
+    public:
+        CmdLineTeeN() : CmdLineTee(store, MaxSinks) {}
+
+    private:
+        Print * store[MaxSinks];
 };
 
 #endif // __COMMANDLINE_H__
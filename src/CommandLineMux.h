@@ -0,0 +1,148 @@
+/** \file CommandLineMux.h */
+/*
+ * NAME: CommandLineMux.h
+ *
+ * WHAT:
+ *  Header file for the command line multiplexer class template.
+ *
+ *  Services several command lines (each with its own stream and command line
+ *  buffer) fairly from a single call in 'loop()'.
+ *
+ * SPECIAL CONSIDERATIONS:
+ *  None
+ *
+ * AUTHOR:
+ *  D.L. Karmann
+ *
+ */
+#ifndef __COMMANDLINEMUX_H__
+#define __COMMANDLINEMUX_H__
+
+#include "CommandLine.h"
+
+/**
+ *  Defines the default maximum number of received characters processed per command line per call.
+ */
+#define CMDLINE_MUX_BUDGET      32
+
+/**
+ * CommandLine multiplexer class template.
+ *
+ * Services up to \e N existing command lines (for example one each on
+ * 'Serial', 'Serial1', 'Serial2' and 'Serial3') round-robin from one
+ * \ref DoCmdLine() call. Each command line keeps its own stream, command line
+ * buffer and settings; the multiplexer only holds pointers to them. Each
+ * command line may process no more than a fixed number of received characters
+ * per call, so a flooding port can not starve the others, and the port that
+ * is serviced first rotates on each call.
+ *
+ * All of the command lines (of any \ref CommandLineN sizes) share the same
+ * parser code; they dispatch into the default \e g_sCmdTable unless given
+ * their own command tables.
+ *
+ * \tparam N: the maximum number of command lines (1 - 16)
+ *
+ * Example:
+ *
+ *     CommandLine CmdLineUsb(Serial);
+ *     CommandLine CmdLine1(Serial1);
+ *     CommandLineMux<2> CmdLines;
+ *
+ *     CmdLines.Add(CmdLineUsb);           // in setup()
+ *     CmdLines.Add(CmdLine1);
+ *
+ *     uint16_t done = CmdLines.DoCmdLine();   // in loop(), bit n set = command line n processed a command
+ */
+template <uint8_t N>
+class CommandLineMux
+{
+    static_assert((N > 0) && (N <= 16), "CommandLineMux supports 1 - 16 command lines");
+
+    public:
+        /**
+         *  A constructor that sets up the multiplexer.
+         *
+         *  \param _budget: the maximum number of received characters processed per command
+         *                 line per \ref DoCmdLine() call (default = \ref CMDLINE_MUX_BUDGET)
+         *
+         *  \return None.
+         */
+        CommandLineMux(uint16_t _budget = CMDLINE_MUX_BUDGET) : count(0), next(0), budget(_budget)
+        {
+        }
+
+        /**
+         * Adds a command line to be serviced.
+         *
+         * \param cmdLine: the command line
+         *
+         * \return   int8_t
+         * \return   - the index of the command line (its bit in the \ref DoCmdLine() result)
+         * \return   - -1 = no room for the command line
+         */
+        int8_t Add(CommandLineBase& cmdLine)
+        {
+            if (count >= N)
+            {
+                return -1;
+            }
+            ports[count] = &cmdLine;
+            return (int8_t)count++;
+        }
+
+        /**
+         * Sets the maximum number of received characters processed per command line per call.
+         *
+         * \param _budget: the maximum number of received characters
+         */
+        void Budget(uint16_t _budget)
+        {
+            budget = _budget;
+        }
+
+        /**
+         * Implements the non-blocking serial command processing for all of the command lines.
+         *
+         * \return   uint16_t
+         * \return   bit mask of the command lines that processed a command (bit n = command line n)
+         *
+         *  \note This should be called in \e 'loop()' to check for/process incoming commands.
+         */
+        uint16_t DoCmdLine(void)
+        {
+            uint16_t done = 0;
+            uint8_t port = next;
+
+            for (uint8_t i = 0; i < count; ++i)
+            {
+                if (ports[port]->DoCmdLine(budget))
+                {
+                    done |= (uint16_t)(1U << port);
+                }
+                if (++port >= count)
+                {
+                    port = 0;
+                }
+            }
+
+            // start with the next command line on the next call
+            if (count && (++next >= count))
+            {
+                next = 0;
+            }
+            return done;
+        }
+
+    private:
+        // the command lines
+        CommandLineBase * ports[N];
+        uint8_t count;
+
+        // the command line to service first on the next call
+        uint8_t next;
+
+        // the maximum received characters processed per command line per call
+        uint16_t budget;
+};
+
+#endif // __COMMANDLINEMUX_H__